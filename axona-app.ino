@@ -2,7 +2,15 @@
 #include <ArduinoBLE.h>
 
 #include "src/BLEManager.hpp"
-#include "src/IMUProcessor.hpp"
+#include "src/CalibrationStore.hpp"
+#include "src/EventLog.hpp"
+#include "src/InternalFlash.hpp"
+#include "src/LatencyTrace.hpp"
+#include "src/MetricJob.hpp"
+#include "src/Profiler.hpp"
+#include "src/RateController.hpp"
+#include "src/SensorHub.hpp"
+#include "src/Telemetry.hpp"
 
 #define LED_PIN_1 11
 #define LED_PIN_2 9
@@ -10,12 +18,77 @@
 #define LED_PIN_4 5
 #define LED_PIN_5 3
 
+#define STATS_INTERVAL 1000
+// A sensor's bias estimate is written back once it has this many new still
+// samples, at most once per interval
+#define CALIBRATION_SAVE_SAMPLES 500
+#define CALIBRATION_SAVE_INTERVAL 60000
+
 BLEManager bleManager;
-IMUProcessor& imuProcessor = IMUProcessor::getInstance();
+MetricJob metricJob(micros);
+InternalFlash eventFlash(EVENT_LOG_FLASH_SIZE);
+EventLog eventLog(eventFlash);
+InternalFlash calibrationFlash(CALIBRATION_FLASH_SIZE, EVENT_LOG_FLASH_SIZE);
+CalibrationStore calibrationStore(calibrationFlash);
+uint32_t savedCalibrationSamples[SENSOR_MAX_DEVICES];
+// Per pipeline: the IMU6 rate follows the sensor's motion
+RateController rateControllers[SENSOR_MAX_DEVICES];
+TelemetryWriter telemetry;
+// Timestamps of each impact from sample to LEDs (trace command)
+LatencyTrace latencyTrace;
+uint32_t tracedImpacts[SENSOR_MAX_DEVICES];
+
+// Up to SENSOR_MAX_DEVICES sensors, e.g. helmet and bike frame; each
+// gets its own processing pipeline
+const char* const sensorAddresses[] = {"74:92:ba:10:e8:23"};
+const int SENSOR_COUNT = sizeof(sensorAddresses) / sizeof(sensorAddresses[0]);
+bool sensorsConnecting = true;
+
+// Connects one sensor and starts its IMU6 stream
+bool connectSensor(const char* address) {
+  int targetIndex = bleManager.getDeviceIndex(address);
+  if (targetIndex == -1) {
+    Serial.print("Sensor not found: ");
+    Serial.println(address);
+    return false;
+  }
+
+  if (!bleManager.selectDevice(targetIndex)) {
+    Serial.println("Failed to select device.");
+    return false;
+  }
+  Serial.println("Device selected successfully");
+
+  // Stored biases apply from the first sample; no calibration wait
+  SensorPipeline* pipeline = bleManager.selectedPipeline();
+  SensorCalibration calibration;
+  if (pipeline && calibrationStore.load(BLEManager::parseAddress(address), calibration)) {
+    pipeline->processor.setCalibration(calibration);
+    Serial.println("Calibration loaded");
+  }
+  if (pipeline) {
+    savedCalibrationSamples[pipeline->id] = 0;
+    tracedImpacts[pipeline->id] = 0;
+    rateControllers[pipeline->id].reset(millis());
+  }
+  
+  // Starts at the riding rate; adaptStreamRates() takes it from there
+  uint8_t subscribeCommand[IMU6_COMMAND_MAX];
+  int commandLength = imu6SubscribeCommand(subscribeCommand, STREAM_REFERENCE, RATE_TIER_RIDING);
+
+  // Kept by BLEManager and replayed if the link drops
+  if(!bleManager.startSensorStream(subscribeCommand, commandLength, RATE_TIER_RIDING)) {
+    Serial.println("Failed to start IMU stream");
+    return false;
+  }
+  Serial.println("Subscribed to IMU sensor");
+  return true;
+}
 
 void setup() {
   Serial.begin(115200);
   while (!Serial) delay(10);
+  profiler::begin();
 
   // Initialize LED pins
   for (int i = 2; i <= 6; i++) {
@@ -29,47 +102,175 @@ void setup() {
   }
   Serial.println("BLE initialized successfully");
 
-  bleManager.scanDevices();
-  bleManager.listDevices();
+  // Impacts are logged to flash even when no host is attached
+  if (!eventFlash.begin() || !eventLog.mount()) {
+    Serial.println("Failed to mount event log");
+  }
+  if (!calibrationFlash.begin() || !calibrationStore.mount()) {
+    Serial.println("Failed to mount calibration store");
+  }
 
-  const char* targetAddress = "74:92:ba:10:e8:23";
-  int targetIndex = bleManager.getDeviceIndex(targetAddress);
-  if (targetIndex == -1) {
-    Serial.println("Target device not found.");
-    return;
+  // The scan runs from loop() and ends as soon as all sensors are seen
+  if (!bleManager.startScan(sensorAddresses, SENSOR_COUNT)) {
+    Serial.println("Failed to start scan");
   }
+}
 
-  if (!bleManager.selectDevice(targetIndex)) {
-    Serial.println("Failed to select device.");
+size_t writeSerial(const uint8_t* data, size_t length, void* context) {
+  (void)context;
+  return Serial.write(data, length);
+}
+
+// Writes back bias estimates that have improved, at most once per interval
+void saveCalibrations() {
+  static unsigned long lastSave = 0;
+  static bool saved = false;
+  if (saved && millis() - lastSave < CALIBRATION_SAVE_INTERVAL) {
     return;
   }
-  Serial.println("Device selected successfully");
-  
-  String sampleRate = "52";
-  const uint8_t subscribeCommand[] = {1, 99, '/', 'M', 'e', 'a', 's', '/', 'I', 'M', 'U', '6', '/', sampleRate.charAt(0), sampleRate.charAt(1), sampleRate.charAt(2), sampleRate.charAt(3)};
-  int commandLength = 13 + sampleRate.length();
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    const BLEManager::Connection& connection = BLEManager::connection(i);
+    if (!connection.device || !connection.pipeline) {
+      continue;
+    }
+    const IMUProcessor& processor = connection.pipeline->processor;
+    uint32_t& savedSamples = savedCalibrationSamples[connection.pipeline->id];
+    SensorCalibration calibration;
+    if (processor.getCalibrationSamples() - savedSamples < CALIBRATION_SAVE_SAMPLES ||
+        !processor.getCalibration(calibration)) {
+      continue;
+    }
+    if (calibrationStore.save(BLEManager::parseAddress(connection.device.address().c_str()), calibration)) {
+      savedSamples = processor.getCalibrationSamples();
+      lastSave = millis();
+      saved = true;
+    }
+  }
+}
 
-  if(!bleManager.writeCharacteristic(5, 0, subscribeCommand, commandLength)) {
-    Serial.println("Failed to write characteristic");
-    return;
+// Moves each streaming sensor to the rate its recent motion asks for
+void adaptStreamRates() {
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    const BLEManager::Connection& connection = BLEManager::connection(i);
+    if (!connection.subscribed || !connection.pipeline) {
+      continue;
+    }
+    RateController& controller = rateControllers[connection.pipeline->id];
+    int rate = controller.update(connection.pipeline->processor.takeActivityPeak(), millis());
+    if (rate != connection.sampleRate) {
+      bleManager.setStreamRate(i, rate);
+    }
   }
-  if(!bleManager.subscribeCharacteristic(5, 1)) {
-    Serial.println("Failed to subscribe to characteristic");
-    return;
+}
+
+// Traces the impacts the last drain triggered, back to their packet's arrival
+void traceDetections() {
+  const uint32_t nowUs = micros();
+  SensorHub& sensors = BLEManager::sensors();
+  for (size_t i = 0; i < SensorHub::capacity(); i++) {
+    const SensorPipeline& pipeline = sensors.pipeline(i);
+    const uint32_t captured = pipeline.processor.getCapturedImpacts();
+    // Fewer than before: the stream was restarted, which clears the count
+    if (!pipeline.attached || captured <= tracedImpacts[i]) {
+      tracedImpacts[i] = captured;
+      continue;
+    }
+    tracedImpacts[i] = captured;
+    const uint32_t triggerUs = pipeline.processor.getLastTriggerTime();
+    if (pipeline.clock.valid()) {
+      latencyTrace.record(TraceStage::SAMPLE, pipeline.id, triggerUs, pipeline.clock.toReceiverUs(triggerUs));
+    }
+    const PacketArrivals::Packet* packet = pipeline.arrivals.find(triggerUs);
+    if (packet) {
+      latencyTrace.record(TraceStage::ARRIVAL, pipeline.id, triggerUs, packet->arrivalUs);
+      latencyTrace.record(TraceStage::INGEST, pipeline.id, triggerUs, packet->ingestUs);
+    }
+    latencyTrace.record(TraceStage::DETECT, pipeline.id, triggerUs, nowUs);
   }
-  Serial.println("Subscribed to IMU sensor");  
+}
+
+void sendStats() {
+  TelemetryStats stats;
+  stats.uptimeMs = millis();
+  // Totals over all sensors; the high-water mark of the fullest queue
+  for (size_t i = 0; i < SensorHub::capacity(); i++) {
+    const SampleQueue& queue = BLEManager::sensors().pipeline(i).queue;
+    stats.samplesPushed += queue.pushed();
+    stats.samplesDropped += queue.dropped();
+    if (queue.highWater() > stats.queueHighWater) stats.queueHighWater = queue.highWater();
+  }
+  stats.framesDropped = telemetry.framesDropped();
+  stats.eventLogRecords = eventLog.nextSequence();
+  telemetry.writeStats(stats);
 }
 
 void loop() {
+  PROFILE_SCOPE(LOOP);
   bleManager.poll();
 
-  // Get impact level (0-4)
-  if (bleManager.isSubscribed()) {
-    int impactLevel = imuProcessor.getImpactLevel();
+  // Connect the sensors once the scan has found them (or timed out)
+  if (sensorsConnecting && !bleManager.scanning()) {
+    sensorsConnecting = false;
+    bleManager.listDevices();
+    for (const char* address : sensorAddresses) {
+      connectSensor(address);
+    }
+
+    // From here on the serial port carries binary telemetry frames
+    BLEManager::setSampleStream(&telemetry);
+  }
+
+  SensorHub& sensors = BLEManager::sensors();
+  sensors.drain();
+  traceDetections();
+  adaptStreamRates();
 
+  // Keep serving impacts while a dropped sensor is being reconnected
+  if (bleManager.isSubscribed() || bleManager.isReconnecting()) {
     static unsigned long lastImpactTime = 0;
     static int lastImpactLevel = 0;
-    const unsigned long LED_DURATION = 3000; // LEDs stay on for 1 second
+    static unsigned long lastStatsTime = 0;
+    static SensorPipeline* jobSensor = nullptr;
+    static bool levelShown = false;
+    static size_t nextSensor = 0;
+    const unsigned long LED_DURATION = 3000; // LEDs stay on for 3 seconds
+
+    // Pick up a completed impact record once the previous report is out,
+    // taking the sensors in turn so none can starve the others
+    for (size_t n = 0; n < SensorHub::capacity() && !metricJob.busy() && !metricJob.done(); n++) {
+      SensorPipeline& pipeline = sensors.pipeline(nextSensor);
+      nextSensor = (nextSensor + 1) % SensorHub::capacity();
+      const ImpactEvent* event = pipeline.attached ? pipeline.processor.getImpactEvent() : nullptr;
+      if (event) {
+        metricJob.start(*event);
+        jobSensor = &pipeline;
+        levelShown = false;
+        latencyTrace.record(TraceStage::CAPTURE, pipeline.id, event->triggerTime, micros());
+      }
+    }
+
+    // Compute the metrics a slice at a time
+    if (metricJob.busy() && metricJob.run(METRIC_JOB_BUDGET_US)) {
+      // Persist the metrics and a snapshot of the impact
+      const ImpactEvent* event = jobSensor->processor.getImpactEvent();
+      if (event) {
+        ImpactRecord record = makeImpactRecord(*event, metricJob.report());
+        record.sensor = jobSensor->id;
+        eventLog.append(record);
+      }
+
+      // Done with this impact record; the next impact can be captured
+      jobSensor->processor.releaseImpactEvent();
+      latencyTrace.record(TraceStage::METRICS, jobSensor->id, metricJob.report().triggerTime, micros());
+    }
+
+    // The 0-4 impact level is the job's first stage; show it right away
+    // rather than after the HIC search and velocities
+    int impactLevel = 0;
+    if (metricJob.levelReady() && !levelShown) {
+      levelShown = true;
+      impactLevel = metricJob.report().level;
+    }
     
     if (impactLevel > 0) {
         lastImpactTime = millis();
@@ -90,38 +291,35 @@ void loop() {
         digitalWrite(LED_PIN_4, LOW);
         digitalWrite(LED_PIN_5, LOW);
     }
-      
     if (impactLevel > 0) {
-      Serial.println("--- Impact Detected ---");
-      Serial.print("Impact Level: ");
-      Serial.println(impactLevel);
-
-      // Get and print HIC (Head Injury Criterion)
-      double hic = imuProcessor.getHIC(15.0);  // 15ms window
-      Serial.println("hicData||" + String(hic, 2));     
-
-      // Determine concussion risk based on HIC
-      String concussionRisk = "Low";
-      if (hic > 1000) {
-        concussionRisk = "High";
-      } else if (hic > 500) {
-        concussionRisk = "Medium";
-      }
-      Serial.println("concussionRisk||" + concussionRisk);
-
-      // Get peak linear acceleration
-      double peakAcc = imuProcessor.getAccOnImpact();
-      Serial.println("peakAcc||" + String(peakAcc, 2) + " g");
+      latencyTrace.record(TraceStage::LED, jobSensor->id, metricJob.report().triggerTime, micros());
+    }
 
-      // Get riding velocity before impact
-      double ridingVelocity = imuProcessor.getRidingVelocitybeforeImpact();
-      Serial.println("RidingVelocity||" + String(ridingVelocity, 2) + " km/h");      
+    // Report a finished impact
+    if (metricJob.done()) {
+      const ImpactReport& report = metricJob.report();
+      if (report.level > 0) {
+        telemetry.writeImpact(report, jobSensor->clock.toReceiverUs(report.triggerTime), jobSensor->id);
+      }
+      metricJob.reset();
+      // Quiet moment after the report: erase the next log page now if
+      // the current one is full, rather than during the next impact
+      eventLog.prepare();
+    }
 
-      // Get head velocity on impact
-      double headVelocity = imuProcessor.getHeadVelocityOnImpact();
-      Serial.println("HeadVelocity||" + String(headVelocity, 2) + " km/h");
+    if (!metricJob.busy()) {
+      saveCalibrations();
+    }
 
-      Serial.println("----------------------\n");
+    if (millis() - lastStatsTime >= STATS_INTERVAL) {
+      lastStatsTime = millis();
+      sendStats();
     }
   }
+
+  // Only hand the UART what it can take without blocking
+  int room = Serial.availableForWrite();
+  if (room > 0 && !sensorsConnecting) {
+    telemetry.pump(room, writeSerial, nullptr);
+  }
 }
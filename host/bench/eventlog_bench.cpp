@@ -0,0 +1,247 @@
+// Exercises EventLog on the file-backed flash stand-in.
+//
+//   eventlog_bench throughput [records]   append/mount/dump speed and wear
+//   eventlog_bench powerloss [trials]     cut power at random points and
+//                                         check what survives a remount
+//   eventlog_bench decode <file>          decode a 'log dump' capture
+//
+// Device times are estimates from the nRF52840 NVMC timings in FileFlash.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "EventLog.hpp"
+#include "FileFlash.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char* IMAGE_PATH = "eventlog_bench.bin";
+
+double elapsedUs(Clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - since).count();
+}
+
+ImpactRecord randomRecord(std::mt19937& rng) {
+    std::uniform_real_distribution<float> metric(0.0f, 500.0f);
+    ImpactRecord r;
+    r.triggerTime = rng();
+    r.level = rng() % 5;
+    r.hic15 = metric(rng);
+    r.hic36 = metric(rng);
+    r.peakAcc = metric(rng);
+    r.ridingVelocity = metric(rng);
+    r.headVelocity = metric(rng);
+    r.snapshotStartMs = -EVENT_LOG_SNAPSHOT_PRE_MS;
+    r.snapshotBinUs = 4700;
+    r.snapshotCount = EVENT_LOG_SNAPSHOT_BINS;
+    for (int i = 0; i < EVENT_LOG_SNAPSHOT_BINS; i++) r.snapshot[i] = rng() & 0xffff;
+    return r;
+}
+
+bool sameRecord(const ImpactRecord& a, const ImpactRecord& b) {
+    return a.sequence == b.sequence && a.triggerTime == b.triggerTime && a.sensor == b.sensor && a.level == b.level &&
+           a.hic15 == b.hic15 && a.hic36 == b.hic36 && a.peakAcc == b.peakAcc &&
+           a.ridingVelocity == b.ridingVelocity && a.headVelocity == b.headVelocity &&
+           a.snapshotStartMs == b.snapshotStartMs && a.snapshotBinUs == b.snapshotBinUs &&
+           a.snapshotCount == b.snapshotCount &&
+           std::memcmp(a.snapshot, b.snapshot, sizeof(a.snapshot[0]) * a.snapshotCount) == 0;
+}
+
+bool collect(const uint8_t* frame, size_t length, void* context) {
+    ImpactRecord record;
+    if (EventLog::decode(frame, length, record)) {
+        static_cast<std::vector<ImpactRecord>*>(context)->push_back(record);
+    }
+    return true;
+}
+
+bool countBytes(const uint8_t* frame, size_t length, void* context) {
+    (void)frame;
+    *static_cast<size_t*>(context) += length;
+    return true;
+}
+
+int throughput(long records) {
+    remove(IMAGE_PATH);
+    FileFlash flash(IMAGE_PATH, EVENT_LOG_FLASH_SIZE);
+    if (!flash.open()) {
+        fprintf(stderr, "cannot open %s\n", IMAGE_PATH);
+        return 1;
+    }
+    EventLog log(flash);
+    log.mount();
+
+    std::mt19937 rng(1);
+    std::vector<ImpactRecord> input;
+    for (long i = 0; i < records; i++) input.push_back(randomRecord(rng));
+
+    Clock::time_point t0 = Clock::now();
+    for (ImpactRecord& r : input) {
+        if (!log.append(r)) {
+            fprintf(stderr, "append failed\n");
+            return 1;
+        }
+    }
+    const double appendUs = elapsedUs(t0);
+
+    t0 = Clock::now();
+    EventLog remounted(flash);
+    remounted.mount();
+    const double mountUs = elapsedUs(t0);
+
+    size_t dumped = 0;
+    t0 = Clock::now();
+    size_t frames = remounted.forEach(countBytes, &dumped);
+    const double dumpUs = elapsedUs(t0);
+
+    uint32_t minErase = 0xffffffff, maxErase = 0;
+    for (uint32_t p = 0; p < flash.size() / flash.pageSize(); p++) {
+        if (flash.eraseCount(p) < minErase) minErase = flash.eraseCount(p);
+        if (flash.eraseCount(p) > maxErase) maxErase = flash.eraseCount(p);
+    }
+
+    printf("records %ld, frame %d bytes, log %d KiB in %u pages\n", records,
+           EVENT_LOG_MAX_FRAME_SIZE, EVENT_LOG_FLASH_SIZE / 1024, flash.size() / flash.pageSize());
+    printf("append: %.2f us/record host, %.0f us/record device (incl. page erases)\n",
+           appendUs / records, flash.deviceBusyUs() / records);
+    printf("mount:  %.1f us, next sequence %u\n", mountUs, remounted.nextSequence());
+    printf("dump:   %zu records, %zu bytes, %.1f MB/s host\n", frames, dumped, dumped / dumpUs);
+    printf("wear:   %llu page erases, per page %u..%u\n",
+           static_cast<unsigned long long>(flash.pageErases()), minErase, maxErase);
+    remove(IMAGE_PATH);
+    return 0;
+}
+
+// One power cut at a random point, then remount and check
+bool powerLossTrial(std::mt19937& rng, int trial) {
+    remove(IMAGE_PATH);
+    FileFlash flash(IMAGE_PATH, EVENT_LOG_FLASH_SIZE);
+    if (!flash.open()) return false;
+    EventLog log(flash);
+    log.mount();
+
+    std::vector<ImpactRecord> acknowledged;
+    const int before = rng() % 1200;
+    for (int i = 0; i < before; i++) {
+        ImpactRecord r = randomRecord(rng);
+        if (log.append(r)) acknowledged.push_back(r);
+    }
+
+    if (rng() % 4 == 0) {
+        flash.failNextErase();
+    } else {
+        flash.failAfterBytes(rng() % (EVENT_LOG_MAX_FRAME_SIZE * 3));
+    }
+    for (int guard = 0; guard < 2000 && !flash.powerLost(); guard++) {
+        ImpactRecord r = randomRecord(rng);
+        if (rng() % 8 == 0) log.prepare();
+        if (log.append(r)) acknowledged.push_back(r);
+    }
+    flash.restorePower();
+
+    // Reboot: everything acknowledged and not yet rotated out must be there
+    // in order, and the log must keep working
+    for (int round = 0; round < 2; round++) {
+        EventLog rebooted(flash);
+        if (!rebooted.mount()) return false;
+        std::vector<ImpactRecord> found;
+        rebooted.forEach(collect, &found);
+
+        if (!acknowledged.empty()) {
+            if (found.empty()) {
+                printf("trial %d: log empty after power loss\n", trial);
+                return false;
+            }
+            size_t first = acknowledged.size() - found.size();
+            if (found.size() > acknowledged.size()) {
+                printf("trial %d: %zu records found, %zu written\n", trial, found.size(), acknowledged.size());
+                return false;
+            }
+            for (size_t i = 0; i < found.size(); i++) {
+                if (!sameRecord(found[i], acknowledged[first + i])) {
+                    printf("trial %d: record %zu differs (seq %u vs %u)\n", trial, i,
+                           found[i].sequence, acknowledged[first + i].sequence);
+                    return false;
+                }
+            }
+        }
+
+        for (int i = 0; i < 40; i++) {
+            ImpactRecord r = randomRecord(rng);
+            if (!rebooted.append(r)) {
+                printf("trial %d: append after reboot failed\n", trial);
+                return false;
+            }
+            acknowledged.push_back(r);
+        }
+    }
+    return true;
+}
+
+int powerLoss(int trials) {
+    std::mt19937 rng(12345);
+    int failures = 0;
+    for (int t = 0; t < trials; t++) {
+        if (!powerLossTrial(rng, t)) failures++;
+    }
+    remove(IMAGE_PATH);
+    printf("power loss: %d trials, %d failures\n", trials, failures);
+    return failures ? 1 : 0;
+}
+
+int decode(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    const char* marker = "EVENTLOG BEGIN\r\n";
+    std::string text(data.begin(), data.end());
+    size_t pos = text.find(marker);
+    if (pos == std::string::npos) {
+        fprintf(stderr, "no dump found\n");
+        return 1;
+    }
+    pos += strlen(marker);
+
+    printf("sequence,sensor,trigger_us,level,hic15,hic36,peak_acc,riding_velocity,head_velocity\n");
+    int bad = 0;
+    while (pos + 4 <= data.size()) {
+        size_t size = EventLog::frameSize(&data[pos]);
+        if (size == 0) break;  // terminator
+        ImpactRecord r;
+        if (EventLog::decode(&data[pos], data.size() - pos, r)) {
+            printf("%u,%u,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", r.sequence, r.sensor, r.triggerTime, r.level,
+                   r.hic15, r.hic36, r.peakAcc, r.ridingVelocity, r.headVelocity);
+        } else {
+            bad++;
+        }
+        pos += size;
+    }
+    if (bad) fprintf(stderr, "%d corrupt frames\n", bad);
+    return bad ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* mode = argc > 1 ? argv[1] : "throughput";
+    if (strcmp(mode, "throughput") == 0) return throughput(argc > 2 ? atol(argv[2]) : 5000);
+    if (strcmp(mode, "powerloss") == 0) return powerLoss(argc > 2 ? atoi(argv[2]) : 500);
+    if (strcmp(mode, "decode") == 0 && argc > 2) return decode(argv[2]);
+    fprintf(stderr, "usage: eventlog_bench throughput [records] | powerloss [trials] | decode <file>\n");
+    return 1;
+}
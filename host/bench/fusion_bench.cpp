@@ -0,0 +1,112 @@
+// Runs the same synthetic ride through each attitude filter and reports
+// the cost per update and the gravity-direction error against RideSim's
+// ground truth. The error is measured on the gravity vector each filter
+// hands to gravity removal, since that is what linear acceleration uses.
+//
+// Usage: fusion_bench [rate_hz] [seconds] [motion_scale]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define FUSION_BENCH_CYCLES 1
+#endif
+
+#include "Fusion.hpp"
+#include "sim/RideSim.hpp"
+
+namespace {
+
+const double RAD_TO_DEG = 57.29577951308232;
+// Ignore the initial convergence from the identity attitude
+const double SETTLE_SECONDS = 5.0;
+
+struct Result {
+    double nsPerUpdate;
+    double cyclesPerUpdate;
+    double meanDeg, rmsDeg, maxDeg;
+};
+
+Result run(FusionAlgorithm algorithm, const std::vector<RideSample>& ride, int rate) {
+    Result r = {};
+    const Scalar dt = S(1.0 / rate);
+    const size_t settle = static_cast<size_t>(SETTLE_SECONDS * rate);
+
+    // Accuracy pass
+    FusionState state;
+    double sum = 0, sumSquared = 0;
+    size_t scored = 0;
+    for (size_t i = 0; i < ride.size(); i++) {
+        const RideSample& s = ride[i];
+        fusionUpdate(algorithm, state, s.gyro[0], s.gyro[1], s.gyro[2],
+                     s.acc[0], s.acc[1], s.acc[2], dt);
+        if (i < settle) continue;
+        Scalar gx, gy, gz;
+        fusionGravity(algorithm, state, gx, gy, gz);
+        double norm = std::sqrt(double(gx) * gx + double(gy) * gy + double(gz) * gz);
+        double dot = (gx * s.gravity[0] + gy * s.gravity[1] + gz * s.gravity[2]) / norm;
+        double deg = std::acos(dot > 1 ? 1 : (dot < -1 ? -1 : dot)) * RAD_TO_DEG;
+        sum += deg;
+        sumSquared += deg * deg;
+        if (deg > r.maxDeg) r.maxDeg = deg;
+        scored++;
+    }
+    r.meanDeg = sum / scored;
+    r.rmsDeg = std::sqrt(sumSquared / scored);
+
+    // Timing pass: update plus gravity extraction, as IMUProcessor does per sample
+    state.reset();
+    Scalar sink = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+#ifdef FUSION_BENCH_CYCLES
+    unsigned long long c0 = __rdtsc();
+#endif
+    for (const RideSample& s : ride) {
+        fusionUpdate(algorithm, state, s.gyro[0], s.gyro[1], s.gyro[2],
+                     s.acc[0], s.acc[1], s.acc[2], dt);
+        Scalar gx, gy, gz;
+        fusionGravity(algorithm, state, gx, gy, gz);
+        sink += gx + gy + gz;
+    }
+#ifdef FUSION_BENCH_CYCLES
+    r.cyclesPerUpdate = double(__rdtsc() - c0) / ride.size();
+#endif
+    r.nsPerUpdate = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - t0).count() / ride.size();
+    if (sink == S(12345)) printf(" ");
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int rate = argc > 1 ? atoi(argv[1]) : 104;
+    const double seconds = argc > 2 ? atof(argv[2]) : 300.0;
+    const double motion = argc > 3 ? atof(argv[3]) : 1.0;
+
+    RideSim sim(rate);
+    sim.setMotion(motion);
+    for (uint32_t t = 20000; t < seconds * 1000.0; t += 20000) {
+        sim.scheduleImpact(t, 4.0f + (t / 20000) % 5, 12.0f);
+    }
+    std::vector<RideSample> ride(static_cast<size_t>(seconds * rate));
+    for (RideSample& s : ride) s = sim.next();
+
+    printf("fusion: %s, %d Hz, %.0f s, motion %.2f\n",
+           sizeof(Scalar) == sizeof(double) ? "double" : "float", rate, seconds, motion);
+    printf("%-14s %9s %9s %9s %9s %9s\n", "filter", "ns/upd", "cyc/upd", "mean_deg", "rms_deg", "max_deg");
+
+    const FusionAlgorithm algorithms[] = {
+        FusionAlgorithm::COMPLEMENTARY, FusionAlgorithm::MADGWICK, FusionAlgorithm::MAHONY
+    };
+    for (FusionAlgorithm algorithm : algorithms) {
+        Result r = run(algorithm, ride, rate);
+        printf("%-14s %9.1f %9.0f %9.3f %9.3f %9.3f\n", fusionName(algorithm),
+               r.nsPerUpdate, r.cyclesPerUpdate, r.meanDeg, r.rmsDeg, r.maxDeg);
+    }
+    return 0;
+}
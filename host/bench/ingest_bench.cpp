@@ -0,0 +1,93 @@
+// Drives the BLE-callback -> SampleQueue -> IMUProcessor hand-off with a
+// real producer thread (standing in for the notification callback) and a
+// real consumer thread (standing in for loop()).
+//
+// Usage: ingest_bench [packets] [rows_per_packet] [packets_per_second, 0 = unthrottled]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "IMUProcessor.hpp"
+#include "MovesenseIMU6.hpp"
+#include "SampleQueue.hpp"
+#include "sim/MovesenseSim.hpp"
+
+int main(int argc, char** argv) {
+    const long packets = argc > 1 ? atol(argv[1]) : 200000;
+    const int rows = argc > 2 ? atoi(argv[2]) : 4;
+    const double rate = argc > 3 ? atof(argv[3]) : 0.0;
+
+    if (rows < 1 || rows > IMU6_MAX_ROWS) {
+        fprintf(stderr, "rows_per_packet must be 1..%d\n", IMU6_MAX_ROWS);
+        return 1;
+    }
+
+    // Pre-encode a ring of packets so the producer only decodes and enqueues
+    const int distinct = 64;
+    std::vector<std::vector<uint8_t>> encoded;
+    std::vector<float> acc(3 * rows), gyro(3 * rows);
+    for (int p = 0; p < distinct; p++) {
+        for (int i = 0; i < rows; i++) {
+            acc[3 * i] = 0.01f * ((p + i) % 7);
+            acc[3 * i + 1] = -0.02f;
+            acc[3 * i + 2] = 9.81f;
+            gyro[3 * i] = gyro[3 * i + 1] = gyro[3 * i + 2] = 0.001f * i;
+        }
+        encoded.push_back(MovesenseSim::encodeIMU6(99, 0, acc.data(), gyro.data(), rows));
+    }
+
+    static SampleQueue queue;
+    IMUProcessor& processor = IMUProcessor::getInstance();
+    std::atomic<bool> producerDone(false);
+    size_t consumed = 0;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    std::thread consumer([&] {
+        for (;;) {
+            bool done = producerDone.load(std::memory_order_acquire);
+            size_t n = drainSampleQueue(queue, processor);
+            consumed += n;
+            if (n == 0) {
+                if (done && queue.empty()) break;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::thread producer([&] {
+        const int rowIntervalMs = 1000 / (rows * 13);
+        for (long p = 0; p < packets; p++) {
+            std::vector<uint8_t>& raw = encoded[p % distinct];
+            // Stamp a monotonic sensor time so dt stays sane
+            uint32_t ts = static_cast<uint32_t>(p * rows * rowIntervalMs);
+            memcpy(raw.data() + 2, &ts, sizeof(ts));
+
+            IMU6Packet packet;
+            if (decodeIMU6Packet(raw.data(), raw.size(), packet) == IMU6Status::OK) {
+                enqueueIMU6Packet(packet, queue);
+            }
+            if (rate > 0.0) {
+                std::this_thread::sleep_until(start + std::chrono::duration<double>((p + 1) / rate));
+            }
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    producer.join();
+    consumer.join();
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("packets      %ld x %d rows\n", packets, rows);
+    printf("elapsed      %.3f s\n", seconds);
+    printf("pushed       %u\n", queue.pushed());
+    printf("processed    %zu (%.0f samples/s)\n", consumed, consumed / seconds);
+    printf("dropped      %u\n", queue.dropped());
+    printf("high water   %u / %zu\n", queue.highWater(), SampleQueue::capacity());
+    return 0;
+}
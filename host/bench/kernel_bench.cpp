@@ -0,0 +1,79 @@
+// Times the dispatching batch kernels against their scalar references and
+// reports the largest difference between the two, per kernel.
+//
+// Usage: kernel_bench [samples] [iterations]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Kernels.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double maxDiff(const std::vector<Scalar>& a, const std::vector<Scalar>& b) {
+    double worst = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        double d = std::fabs(double(a[i]) - double(b[i]));
+        if (d > worst) worst = d;
+    }
+    return worst;
+}
+
+template<typename F>
+double nsPerSample(F&& run, size_t samples, int iterations) {
+    Clock::time_point start = Clock::now();
+    for (int it = 0; it < iterations; it++) run();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ns / (double(samples) * iterations);
+}
+
+void report(const char* name, double fast, double ref, double diff) {
+    printf("%-11s %8.3f %8.3f %7.2fx %10.3g\n", name, fast, ref, ref / fast, diff);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 16;
+    const int iterations = argc > 2 ? atoi(argv[2]) : 200000;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> accDist(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> dtDist(0.0009f, 0.0011f);
+
+    std::vector<float> xyz(3 * n);
+    for (float& v : xyz) v = accDist(rng);
+    std::vector<Scalar> x(n), y(n), z(n), dt(n);
+    kernels::deinterleave3(xyz.data(), x.data(), y.data(), z.data(), n);
+    for (Scalar& v : dt) v = dtDist(rng);
+
+    std::vector<Scalar> fast(n), ref(n);
+    const Scalar bias = S(0.125);
+
+    printf("kernels: %s, %zu samples x %d iterations\n", kernels::implementation(), n, iterations);
+    printf("%-11s %8s %8s %8s %10s\n", "kernel", "ns/samp", "ref", "speedup", "max_diff");
+
+    double tf = nsPerSample([&] { kernels::offset(x.data(), bias, fast.data(), n); }, n, iterations);
+    double tr = nsPerSample([&] { kernels::reference::offset(x.data(), bias, ref.data(), n); }, n, iterations);
+    report("offset", tf, tr, maxDiff(fast, ref));
+
+    tf = nsPerSample([&] { kernels::subtract(x.data(), y.data(), fast.data(), n); }, n, iterations);
+    tr = nsPerSample([&] { kernels::reference::subtract(x.data(), y.data(), ref.data(), n); }, n, iterations);
+    report("subtract", tf, tr, maxDiff(fast, ref));
+
+    tf = nsPerSample([&] { kernels::magnitude3(x.data(), y.data(), z.data(), fast.data(), n); }, n, iterations);
+    tr = nsPerSample([&] { kernels::reference::magnitude3(x.data(), y.data(), z.data(), ref.data(), n); }, n, iterations);
+    report("magnitude3", tf, tr, maxDiff(fast, ref));
+
+    tf = nsPerSample([&] { kernels::trapezoid(x.data(), dt.data(), S(0.5), S(1), fast.data(), n); }, n, iterations);
+    tr = nsPerSample([&] { kernels::reference::trapezoid(x.data(), dt.data(), S(0.5), S(1), ref.data(), n); }, n, iterations);
+    report("trapezoid", tf, tr, maxDiff(fast, ref));
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Runs a deterministic synthetic ride through IMUProcessor and prints the
+// impact metrics and the time per sample. Built twice, against the float
+// core (as on the Cortex-M4F) and the double reference core, so the two
+// outputs can be compared directly.
+//
+// Usage: precision_bench_float|precision_bench_double [rate_hz] [seconds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "IMUProcessor.hpp"
+#include "sim/RideSim.hpp"
+
+int main(int argc, char** argv) {
+    const int rate = argc > 1 ? atoi(argv[1]) : 104;
+    const double seconds = argc > 2 ? atof(argv[2]) : 120.0;
+
+    RideSim ride(rate);
+    for (uint32_t t = 20000; t < seconds * 1000.0; t += 20000) {
+        ride.scheduleImpact(t, 4.0f + (t / 20000) % 5, 12.0f);
+    }
+
+    IMUProcessor& processor = IMUProcessor::getInstance();
+    const long total = static_cast<long>(seconds * rate);
+    double processNs = 0.0;
+    int impacts = 0;
+
+    printf("precision: %s\n", sizeof(Scalar) == sizeof(double) ? "double" : "float");
+    printf("time_us,hic15,hic36,peak_acc,riding_velocity,head_velocity\n");
+
+    using Clock = std::chrono::steady_clock;
+    for (long i = 0; i < total; i++) {
+        RideSample s = ride.next();
+        Clock::time_point t0 = Clock::now();
+        processor.processData(s.acc[0], s.acc[1], s.acc[2], s.gyro[0], s.gyro[1], s.gyro[2], s.timestampUs);
+        processNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        // Evaluate each impact once its record is complete
+        if (const ImpactEvent* event = processor.getImpactEvent()) {
+            HICResult hic = processor.getHIC15And36();
+            printf("%u,%.6f,%.6f,%.6f,%.6f,%.6f\n", event->triggerTime,
+                   static_cast<double>(hic.hic15), static_cast<double>(hic.hic36),
+                   static_cast<double>(processor.getAccOnImpact()),
+                   static_cast<double>(processor.getRidingVelocitybeforeImpact()),
+                   static_cast<double>(processor.getHeadVelocityOnImpact()));
+            processor.releaseImpactEvent();
+            impacts++;
+        }
+    }
+
+    printf("samples %ld, impacts %d, processData %.1f ns/sample\n", total, impacts, processNs / total);
+    return 0;
+}
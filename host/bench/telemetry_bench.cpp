@@ -0,0 +1,101 @@
+// Serial bandwidth of raw sample streaming: the old BLE_DEBUG text lines
+// against binary telemetry frames, for each Movesense rate, next to what a
+// 115200 baud UART can carry. Also times frame encoding and host decoding.
+//
+// Usage: telemetry_bench [seconds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "MovesenseIMU6.hpp"
+#include "Telemetry.hpp"
+#include "TelemetryDecoder.hpp"
+#include "sim/MovesenseSim.hpp"
+#include "sim/RideSim.hpp"
+
+namespace {
+
+// 8N1: ten bits on the wire per byte
+const double UART_BYTES_PER_SECOND = 115200.0 / 10.0;
+
+size_t capture(const uint8_t* data, size_t length, void* context) {
+    std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(context);
+    out->insert(out->end(), data, data + length);
+    return length;
+}
+
+// One "accX:.. accY:.. ... gyroZ:..\r\n" line as Serial.print(float) formats it
+size_t textLineSize(const float* acc, const float* gyro) {
+    char line[160];
+    return snprintf(line, sizeof(line), "accX:%.2f accY:%.2f accZ:%.2f gyroX:%.2f gyroY:%.2f gyroZ:%.2f\r\n",
+                    acc[0], acc[1], acc[2], gyro[0], gyro[1], gyro[2]);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 60.0;
+    const int rates[] = {26, 52, 104, 208, 416, 833};
+
+    printf("%6s %6s %12s %12s %8s %8s %12s %12s\n", "rate", "rows", "text B/s", "binary B/s",
+           "text %", "bin %", "encode ns", "decode ns");
+
+    for (int rate : rates) {
+        RideSim ride(rate);
+        const int rows = rate / 13 > MOVESENSE_SIM_MAX_ROWS ? MOVESENSE_SIM_MAX_ROWS : (rate / 13 > 0 ? rate / 13 : 1);
+        const size_t packets = static_cast<size_t>(seconds * rate / rows);
+
+        // Build the packets first so only encoding is timed
+        std::vector<std::vector<uint8_t>> raw(packets);
+        size_t textBytes = 0;
+        for (size_t p = 0; p < packets; ++p) {
+            std::vector<float> acc(3 * rows), gyro(3 * rows);
+            uint32_t timestamp = 0;
+            for (int i = 0; i < rows; ++i) {
+                RideSample s = ride.next();
+                if (i == 0) timestamp = s.timestamp;
+                for (int k = 0; k < 3; ++k) {
+                    acc[3 * i + k] = s.acc[k];
+                    gyro[3 * i + k] = s.gyro[k];
+                }
+                textBytes += textLineSize(&acc[3 * i], &gyro[3 * i]);
+            }
+            raw[p] = MovesenseSim::encodeIMU6(99, timestamp, acc.data(), gyro.data(), rows);
+        }
+
+        TelemetryWriter writer;
+        std::vector<uint8_t> stream;
+        stream.reserve(packets * TELEMETRY_MAX_FRAME);
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t p = 0; p < packets; ++p) {
+            IMU6Packet packet;
+            decodeIMU6Packet(raw[p].data(), raw[p].size(), packet);
+            writer.writeSamples(packet, static_cast<uint32_t>(p * 1000));
+            writer.pump(TELEMETRY_TX_BUFFER_SIZE, capture, &stream);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        telemetry::Decoder decoder;
+        size_t decodedRows = 0;
+        decoder.onSamples = [&](const telemetry::SamplesRecord& r) { decodedRows += r.rows.size(); };
+        auto t2 = std::chrono::steady_clock::now();
+        decoder.feed(stream.data(), stream.size());
+        auto t3 = std::chrono::steady_clock::now();
+
+        if (decodedRows != packets * rows || decoder.counters().invalidFrames != 0 || writer.framesDropped() != 0) {
+            fprintf(stderr, "round trip failed at %d Hz: %zu of %zu rows\n", rate, decodedRows, packets * rows);
+            return 1;
+        }
+
+        const double span = packets * rows / double(rate);
+        const double textRate = textBytes / span;
+        const double binaryRate = stream.size() / span;
+        printf("%6d %6d %12.0f %12.0f %7.0f%% %7.0f%% %12.1f %12.1f\n", rate, rows, textRate, binaryRate,
+               100.0 * textRate / UART_BYTES_PER_SECOND, 100.0 * binaryRate / UART_BYTES_PER_SECOND,
+               std::chrono::duration<double, std::nano>(t1 - t0).count() / packets,
+               std::chrono::duration<double, std::nano>(t3 - t2).count() / packets);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "ColumnarFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[8] = {'A', 'X', 'C', 'O', 'L', 'S', '1', '\0'};
+const size_t NAME_SIZE = 32;
+const size_t DESCRIPTOR_SIZE = NAME_SIZE + 8 + 8;
+
+uint64_t padded(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+} // namespace
+
+size_t ColumnarTable::width(Type type) {
+    switch (type) {
+        case U8: return 1;
+        case U32: return 4;
+        case F32: return 4;
+        case U64: return 8;
+    }
+    return 0;
+}
+
+size_t ColumnarTable::addColumn(const std::string& name, Type type) {
+    columns_.push_back(Column{name.substr(0, NAME_SIZE - 1), type, {}});
+    return columns_.size() - 1;
+}
+
+void ColumnarTable::append(size_t column, const void* value, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    columns_[column].data.insert(columns_[column].data.end(), bytes, bytes + size);
+}
+
+size_t ColumnarTable::rows() const {
+    size_t rows = SIZE_MAX;
+    for (const Column& c : columns_) {
+        const size_t n = c.data.size() / width(c.type);
+        if (n < rows) rows = n;
+    }
+    return columns_.empty() ? 0 : rows;
+}
+
+bool ColumnarTable::write(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    const uint32_t count = static_cast<uint32_t>(columns_.size());
+    const uint32_t reserved = 0;
+    const uint64_t rowCount = rows();
+    bool ok = fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1 &&
+              fwrite(&count, 4, 1, file) == 1 &&
+              fwrite(&reserved, 4, 1, file) == 1 &&
+              fwrite(&rowCount, 8, 1, file) == 1;
+
+    uint64_t offset = sizeof(MAGIC) + 16 + count * DESCRIPTOR_SIZE;
+    for (const Column& c : columns_) {
+        char name[NAME_SIZE] = {};
+        memcpy(name, c.name.data(), c.name.size());
+        uint8_t type[8] = {c.type};
+        ok = ok && fwrite(name, NAME_SIZE, 1, file) == 1 && fwrite(type, 8, 1, file) == 1 &&
+             fwrite(&offset, 8, 1, file) == 1;
+        offset += padded(rowCount * width(c.type));
+    }
+
+    const uint8_t zeros[8] = {};
+    for (const Column& c : columns_) {
+        const size_t size = rowCount * width(c.type);
+        ok = ok && fwrite(c.data.data(), 1, size, file) == size &&
+             fwrite(zeros, 1, padded(size) - size, file) == padded(size) - size;
+    }
+    return fclose(file) == 0 && ok;
+}
+
+bool ColumnarTable::writeCsv(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        fprintf(file, "%s%s", i ? "," : "", columns_[i].name.c_str());
+    }
+    fputc('\n', file);
+
+    const size_t rowCount = rows();
+    for (size_t r = 0; r < rowCount; ++r) {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            const Column& c = columns_[i];
+            const uint8_t* p = c.data.data() + r * width(c.type);
+            if (i) fputc(',', file);
+            switch (c.type) {
+                case U8: fprintf(file, "%u", *p); break;
+                case U32: { uint32_t v; memcpy(&v, p, 4); fprintf(file, "%u", v); break; }
+                case F32: { float v; memcpy(&v, p, 4); fprintf(file, "%.9g", v); break; }
+                case U64: { uint64_t v; memcpy(&v, p, 8); fprintf(file, "%llu", static_cast<unsigned long long>(v)); break; }
+            }
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
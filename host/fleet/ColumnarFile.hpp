@@ -0,0 +1,53 @@
+// Minimal column-oriented table file for analysis results.
+//
+// Layout (little endian):
+//
+//   magic "AXCOLS1\0"
+//   u32 column count, u32 reserved, u64 row count
+//   per column: name (32 bytes, NUL padded), u8 type, 7 bytes reserved,
+//               u64 file offset of the column data
+//   column data, each column contiguous and 8-byte aligned
+//
+// Types are fixed-width, so column i of row r is at offset + r * width.
+// numpy.frombuffer reads a column straight from the mapped file.
+
+#ifndef COLUMNAR_FILE_H
+#define COLUMNAR_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ColumnarTable {
+public:
+    enum Type : uint8_t { U8 = 1, U32 = 2, F32 = 3, U64 = 4 };
+
+    // Returns the column index
+    size_t addColumn(const std::string& name, Type type);
+
+    void appendU8(size_t column, uint8_t value) { append(column, &value, 1); }
+    void appendU32(size_t column, uint32_t value) { append(column, &value, 4); }
+    void appendF32(size_t column, float value) { append(column, &value, 4); }
+    void appendU64(size_t column, uint64_t value) { append(column, &value, 8); }
+
+    // Rows are complete once every column has the same number of values
+    size_t rows() const;
+    bool write(const char* path) const;
+    // Same content as CSV, one line per row
+    bool writeCsv(const char* path) const;
+
+private:
+    struct Column {
+        std::string name;
+        Type type;
+        std::vector<uint8_t> data;
+    };
+
+    static size_t width(Type type);
+    void append(size_t column, const void* value, size_t size);
+
+    std::vector<Column> columns_;
+};
+
+#endif
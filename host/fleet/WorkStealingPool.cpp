@@ -0,0 +1,58 @@
+#include "WorkStealingPool.hpp"
+
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : threads_(threads ? threads : 1), steals_(0) {
+    for (unsigned i = 0; i < threads_; ++i) {
+        queues_.emplace_back(new Queue);
+    }
+}
+
+void WorkStealingPool::run(const std::vector<size_t>& order, const std::function<void(size_t)>& task) {
+    steals_ = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        queues_[i % threads_]->tasks.push_back(order[i]);
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads_; ++i) {
+        workers.emplace_back(&WorkStealingPool::work, this, i, std::cref(task));
+    }
+    // The calling thread is worker 0
+    work(0, task);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+bool WorkStealingPool::popOwn(unsigned worker, size_t& task) {
+    Queue& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned worker, size_t& task) {
+    // Start with the next worker so thieves spread over the victims
+    for (unsigned n = 1; n < threads_; ++n) {
+        Queue& queue = *queues_[(worker + n) % threads_];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        steals_++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::work(unsigned worker, const std::function<void(size_t)>& task) {
+    // No task ever queues another, so once every deque is empty we are done
+    size_t next;
+    while (popOwn(worker, next) || steal(worker, next)) {
+        task(next);
+    }
+}
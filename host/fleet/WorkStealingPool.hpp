@@ -0,0 +1,47 @@
+// Fixed set of worker threads that run a batch of independent tasks.
+//
+// Each worker owns a deque of task indices. It takes work from the front
+// of its own deque, and when that runs dry it steals from the back of
+// another worker's. Tasks should be queued longest first, so the large
+// ones start early and stealing evens out the tail.
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads);
+
+    // Runs task(order[i]) for every entry of order and returns when all
+    // have finished. Tasks are dealt out round-robin in the given order.
+    void run(const std::vector<size_t>& order, const std::function<void(size_t)>& task);
+
+    unsigned threads() const { return threads_; }
+    // Tasks taken from another worker's deque during the last run()
+    uint64_t steals() const { return steals_.load(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    bool popOwn(unsigned worker, size_t& task);
+    bool steal(unsigned worker, size_t& task);
+    void work(unsigned worker, const std::function<void(size_t)>& task);
+
+    unsigned threads_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic<uint64_t> steals_;
+};
+
+#endif
@@ -0,0 +1,34 @@
+// Host runner for the firmware: drives setup()/loop() against a simulated
+// Movesense sensor so the production code can be profiled on a workstation.
+//
+// Usage: axona_host [seconds] [impact_at_ms peak_g duration_ms]...
+
+#include <Arduino.h>
+#include <cstdlib>
+#include "sim/MovesenseSim.hpp"
+
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 20.0;
+
+    MovesenseSim sensor("74:92:ba:10:e8:23");
+    if (argc > 2) {
+        for (int i = 2; i + 2 < argc; i += 3) {
+            sensor.scheduleImpact(strtoul(argv[i], nullptr, 10), atof(argv[i + 1]), atof(argv[i + 2]));
+        }
+    } else {
+        // A few seconds of stillness first, so the bias estimate has settled
+        sensor.scheduleImpact(8000, 6.0f, 40.0f);
+    }
+    blesim::registerPeripheral(&sensor);
+
+    setup();
+    const unsigned long endMs = static_cast<unsigned long>(seconds * 1000.0);
+    while (millis() < endMs) {
+        loop();
+    }
+    Serial.flush();
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "Recording.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const uint8_t PADDING[8] = {};
+
+uint64_t padded(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+} // namespace
+
+RecordingWriter::~RecordingWriter() {
+    if (file_) fclose(file_);
+}
+
+bool RecordingWriter::create(const char* path) {
+    file_ = fopen(path, "wb");
+    if (!file_) return false;
+
+    memcpy(header_.magic, RECORDING_MAGIC, sizeof(header_.magic));
+    header_.version = RECORDING_VERSION;
+    header_.headerSize = sizeof(RecordingHeader);
+    offset_ = sizeof(RecordingHeader);
+    offsets_.clear();
+    return fwrite(&header_, sizeof(header_), 1, file_) == 1;
+}
+
+bool RecordingWriter::append(uint64_t arrivalUs, const uint8_t* data, size_t length, uint8_t device) {
+    if (!file_ || length > 0xffff) return false;
+
+    PacketHeader packet = {};
+    packet.arrivalUs = arrivalUs;
+    packet.length = static_cast<uint16_t>(length);
+    packet.device = device;
+
+    const uint64_t size = sizeof(packet) + length;
+    if (fwrite(&packet, sizeof(packet), 1, file_) != 1 ||
+        fwrite(data, 1, length, file_) != length ||
+        fwrite(PADDING, 1, padded(size) - size, file_) != padded(size) - size) {
+        return false;
+    }
+
+    if (offsets_.empty()) header_.firstArrivalUs = arrivalUs;
+    header_.lastArrivalUs = arrivalUs;
+    offsets_.push_back(offset_);
+    offset_ += padded(size);
+    return true;
+}
+
+bool RecordingWriter::finish() {
+    if (!file_) return false;
+
+    header_.packetCount = offsets_.size();
+    header_.indexOffset = offset_;
+    bool ok = fwrite(offsets_.data(), sizeof(uint64_t), offsets_.size(), file_) == offsets_.size() &&
+              fseek(file_, 0, SEEK_SET) == 0 &&
+              fwrite(&header_, sizeof(header_), 1, file_) == 1;
+    ok = fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+Recording::~Recording() {
+    close();
+}
+
+bool Recording::open(const char* path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RecordingHeader)) {
+        ::close(fd);
+        return false;
+    }
+    mappedSize_ = st.st_size;
+    void* map = mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    base_ = static_cast<const uint8_t*>(map);
+    // Replay walks the file front to back
+    madvise(map, mappedSize_, MADV_SEQUENTIAL);
+
+    const RecordingHeader& h = header();
+    if (memcmp(h.magic, RECORDING_MAGIC, sizeof(h.magic)) != 0 || h.version != RECORDING_VERSION ||
+        h.headerSize != sizeof(RecordingHeader)) {
+        close();
+        return false;
+    }
+
+    if (h.indexOffset != 0 && h.indexOffset % 8 == 0 &&
+        h.indexOffset + h.packetCount * sizeof(uint64_t) <= mappedSize_) {
+        index_ = reinterpret_cast<const uint64_t*>(base_ + h.indexOffset);
+        count_ = h.packetCount;
+        if (indexValid()) return true;
+    }
+    return rebuildIndex();
+}
+
+bool Recording::indexValid() const {
+    for (size_t i = 0; i < count_; ++i) {
+        const uint64_t offset = index_[i];
+        if (offset % 8 != 0 || offset + sizeof(PacketHeader) > mappedSize_) return false;
+        const PacketHeader* packet = reinterpret_cast<const PacketHeader*>(base_ + offset);
+        if (offset + sizeof(PacketHeader) + packet->length > mappedSize_) return false;
+    }
+    return true;
+}
+
+bool Recording::rebuildIndex() {
+    rebuiltIndex_ = true;
+    uint64_t offset = sizeof(RecordingHeader);
+    while (offset + sizeof(PacketHeader) <= mappedSize_) {
+        const PacketHeader* packet = reinterpret_cast<const PacketHeader*>(base_ + offset);
+        const uint64_t size = sizeof(PacketHeader) + packet->length;
+        if (offset + size > mappedSize_) break;
+        rebuilt_.push_back(offset);
+        offset += padded(size);
+    }
+    index_ = rebuilt_.data();
+    count_ = rebuilt_.size();
+    return true;
+}
+
+RecordedPacket Recording::packet(size_t i) const {
+    const PacketHeader* header = reinterpret_cast<const PacketHeader*>(base_ + index_[i]);
+    RecordedPacket packet;
+    packet.arrivalUs = header->arrivalUs;
+    packet.device = header->device;
+    packet.data = base_ + index_[i] + sizeof(PacketHeader);
+    packet.length = header->length;
+    return packet;
+}
+
+void Recording::close() {
+    if (base_) munmap(const_cast<uint8_t*>(base_), mappedSize_);
+    base_ = nullptr;
+    mappedSize_ = 0;
+    index_ = nullptr;
+    count_ = 0;
+    rebuiltIndex_ = false;
+    rebuilt_.clear();
+}
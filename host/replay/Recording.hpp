@@ -0,0 +1,97 @@
+// Session recordings: raw Movesense IMU6 notifications with their arrival
+// times, in a file that is replayed straight from a memory mapping.
+//
+// Layout (little endian, every part 8-byte aligned):
+//
+//   RecordingHeader                          64 bytes
+//   per packet: PacketHeader, payload        padded to 8 bytes
+//   index: u64 file offset per packet        written by finish()
+//
+// A recording that was never finished (indexOffset == 0, e.g. the capture
+// was killed) is still readable: the reader rebuilds the index by walking
+// the packets and stops at the first incomplete one.
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#define RECORDING_MAGIC "AXONAREC"
+#define RECORDING_VERSION 1
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t packetCount;
+    uint64_t indexOffset;       // 0 until finish()
+    uint64_t firstArrivalUs;
+    uint64_t lastArrivalUs;
+    uint8_t reserved[16];
+};
+
+struct PacketHeader {
+    uint64_t arrivalUs;         // receiver clock, unwrapped
+    uint16_t length;            // payload bytes
+    uint8_t device;             // sensor the packet came from
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(RecordingHeader) == 64, "recording header layout");
+static_assert(sizeof(PacketHeader) == 16, "packet header layout");
+
+// One packet as mapped from the file
+struct RecordedPacket {
+    uint64_t arrivalUs;
+    uint8_t device;
+    const uint8_t* data;
+    size_t length;
+};
+
+class RecordingWriter {
+public:
+    ~RecordingWriter();
+
+    bool create(const char* path);
+    bool append(uint64_t arrivalUs, const uint8_t* data, size_t length, uint8_t device = 0);
+    // Writes the index and the final header
+    bool finish();
+
+    uint64_t packetCount() const { return offsets_.size(); }
+
+private:
+    FILE* file_ = nullptr;
+    uint64_t offset_ = 0;
+    RecordingHeader header_ = {};
+    std::vector<uint64_t> offsets_;
+};
+
+class Recording {
+public:
+    ~Recording();
+
+    bool open(const char* path);
+    void close();
+
+    size_t size() const { return count_; }
+    RecordedPacket packet(size_t i) const;
+    const RecordingHeader& header() const { return *reinterpret_cast<const RecordingHeader*>(base_); }
+    // False if the index had to be rebuilt
+    bool finished() const { return !rebuiltIndex_; }
+
+private:
+    bool indexValid() const;
+    bool rebuildIndex();
+
+    const uint8_t* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    const uint64_t* index_ = nullptr;
+    size_t count_ = 0;
+    bool rebuiltIndex_ = false;
+    std::vector<uint64_t> rebuilt_;
+};
+
+#endif
@@ -0,0 +1,126 @@
+// Creates session recordings for axona_replay.
+//
+//   axona_record telemetry <capture|-> <out>   IMU6 packets from a binary serial
+//                                              telemetry capture (e.g. axona_host
+//                                              output or a serial log)
+//   axona_record ride <out> [rate_hz] [seconds] [seed] [impact_at_ms peak_g duration_ms]...
+//                                              synthetic RideSim ride, packetized
+//                                              like the Movesense stream; the seed
+//                                              picks the sensor noise
+//
+// Telemetry arrival times are the device's 32-bit micros(); they are
+// unwrapped into the recording's 64-bit clock.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "MovesenseIMU6.hpp"
+#include "Recording.hpp"
+#include "TelemetryDecoder.hpp"
+#include "sim/MovesenseSim.hpp"
+#include "sim/RideSim.hpp"
+
+namespace {
+
+int fromTelemetry(const char* input, const char* output) {
+    FILE* in = strcmp(input, "-") == 0 ? stdin : fopen(input, "rb");
+    if (!in) {
+        perror(input);
+        return 1;
+    }
+    RecordingWriter writer;
+    if (!writer.create(output)) {
+        perror(output);
+        return 1;
+    }
+
+    bool ok = true;
+    // Arrival times are one receiver clock, whichever sensor sent the packet
+    bool first = true;
+    uint32_t lastArrival = 0;
+    uint64_t arrival = 0;
+    telemetry::Decoder decoder;
+    decoder.onSamples = [&](const telemetry::SamplesRecord& r) {
+        // Modular difference survives the 71-minute micros() wrap
+        arrival = first ? r.arrivalUs : arrival + uint32_t(r.arrivalUs - lastArrival);
+        lastArrival = r.arrivalUs;
+        first = false;
+        ok = writer.append(arrival, r.payload, r.length, r.device) && ok;
+    };
+
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        decoder.feed(buffer, n);
+    }
+    if (in != stdin) fclose(in);
+
+    ok = writer.finish() && ok;
+    const telemetry::Decoder::Counters& c = decoder.counters();
+    fprintf(stderr, "%" PRIu64 " packets recorded, %" PRIu64 " invalid frames, %" PRIu64 " lost\n",
+            writer.packetCount(), c.invalidFrames, c.sequenceGaps);
+    return ok ? 0 : 1;
+}
+
+int fromRide(int argc, char** argv) {
+    const char* output = argv[0];
+    const int rate = argc > 1 ? atoi(argv[1]) : 52;
+    const double seconds = argc > 2 ? atof(argv[2]) : 60.0;
+    const uint32_t seed = argc > 3 ? strtoul(argv[3], nullptr, 10) : 1;
+
+    // The decoder derives the rate from the rows per packet (13 Hz per row)
+    const int rows = rate / 13;
+    if (rows < 1 || rows > IMU6_MAX_ROWS || rows * 13 != rate) {
+        fprintf(stderr, "rate_hz must be a multiple of 13 up to %d\n", IMU6_MAX_ROWS * 13);
+        return 1;
+    }
+
+    RideSim ride(rate, seed);
+    for (int i = 4; i + 2 < argc; i += 3) {
+        ride.scheduleImpact(strtoul(argv[i], nullptr, 10), atof(argv[i + 1]), atof(argv[i + 2]));
+    }
+
+    RecordingWriter writer;
+    if (!writer.create(output)) {
+        perror(output);
+        return 1;
+    }
+
+    const long packets = static_cast<long>(seconds * rate / rows);
+    std::vector<float> acc(3 * rows), gyro(3 * rows);
+    bool ok = true;
+    for (long p = 0; p < packets; ++p) {
+        uint32_t timestamp = 0, last = 0;
+        for (int i = 0; i < rows; ++i) {
+            RideSample s = ride.next();
+            if (i == 0) timestamp = s.timestamp;
+            last = s.timestamp;
+            memcpy(&acc[3 * i], s.acc, sizeof(s.acc));
+            memcpy(&gyro[3 * i], s.gyro, sizeof(s.gyro));
+        }
+        std::vector<uint8_t> packet = MovesenseSim::encodeIMU6(99, timestamp, acc.data(), gyro.data(), rows);
+        // Notified shortly after the last row was sampled
+        const uint64_t arrivalUs = uint64_t(last) * 1000 + 1500;
+        ok = writer.append(arrivalUs, packet.data(), packet.size()) && ok;
+    }
+    ok = writer.finish() && ok;
+    fprintf(stderr, "%" PRIu64 " packets recorded\n", writer.packetCount());
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "telemetry") == 0) {
+        return fromTelemetry(argv[2], argv[3]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "ride") == 0) {
+        return fromRide(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "usage: axona_record telemetry <capture|-> <out>\n"
+                    "       axona_record ride <out> [rate_hz] [seconds] [seed] [impact_at_ms peak_g duration_ms]...\n");
+    return 1;
+}
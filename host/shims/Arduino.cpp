@@ -0,0 +1,136 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point bootTime = Clock::now();
+
+uint8_t pinModes[NUM_DIGITAL_PINS];
+uint8_t pinLevels[NUM_DIGITAL_PINS];
+
+std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+    if (base < 2) base = 10;
+    char buf[8 * sizeof(unsigned long) + 2];
+    char* p = buf + sizeof(buf);
+    *--p = '\0';
+    do {
+        unsigned digit = value % base;
+        *--p = static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value);
+    if (negative) *--p = '-';
+    return p;
+}
+
+std::string formatFloat(double value, unsigned char decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    return buf;
+}
+
+} // namespace
+
+unsigned long millis() {
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - bootTime).count());
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count());
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < NUM_DIGITAL_PINS) pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < NUM_DIGITAL_PINS) pinLevels[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < NUM_DIGITAL_PINS ? pinLevels[pin] : LOW;
+}
+
+String::String(int value, unsigned char base)
+    : s_(base == DEC ? formatInteger(value < 0 ? 0UL - static_cast<unsigned long>(value) : value, value < 0, base)
+                     : formatInteger(static_cast<unsigned int>(value), false, base)) {}
+String::String(unsigned int value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base)
+    : s_(base == DEC ? formatInteger(value < 0 ? 0UL - static_cast<unsigned long>(value) : value, value < 0, base)
+                     : formatInteger(static_cast<unsigned long>(value), false, base)) {}
+String::String(unsigned long value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(float value, unsigned char decimalPlaces) : s_(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned char decimalPlaces) : s_(formatFloat(value, decimalPlaces)) {}
+
+void String::trim() {
+    const char* ws = " \t\r\n\f\v";
+    size_t first = s_.find_first_not_of(ws);
+    if (first == std::string::npos) {
+        s_.clear();
+        return;
+    }
+    s_ = s_.substr(first, s_.find_last_not_of(ws) - first + 1);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string out;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) {
+        out += static_cast<char>(c);
+    }
+    return String(out);
+}
+
+HostSerial Serial;
+
+size_t HostSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HostSerial::flush() {
+    fflush(stdout);
+}
+
+int HostSerial::available() {
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    return static_cast<int>(rx_.size());
+}
+
+int HostSerial::read() {
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    if (rx_.empty()) return -1;
+    int c = static_cast<unsigned char>(rx_[0]);
+    rx_.erase(0, 1);
+    return c;
+}
+
+void HostSerial::injectInput(const char* text) {
+    std::lock_guard<std::mutex> lock(rxMutex_);
+    rx_ += text;
+}
@@ -0,0 +1,130 @@
+#ifndef AXONA_HOST_ARDUINO_H
+#define AXONA_HOST_ARDUINO_H
+
+// Host stand-in for the subset of the Arduino core used by the firmware.
+//
+// Together with ArduinoBLE.h this is the hardware abstraction the sketch
+// relies on: clock (millis/micros/delay), GPIO (pinMode/digitalWrite),
+// Serial and BLE. The portable core in src/ never includes it.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+
+#define DEC 10
+#define HEX 16
+
+#define NUM_DIGITAL_PINS 32
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+class String {
+public:
+    String(const char* cstr = "") : s_(cstr ? cstr : "") {}
+    String(const std::string& str) : s_(str) {}
+    explicit String(char c) : s_(1, c) {}
+    explicit String(int value, unsigned char base = DEC);
+    explicit String(unsigned int value, unsigned char base = DEC);
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    unsigned int length() const { return static_cast<unsigned int>(s_.size()); }
+    const char* c_str() const { return s_.c_str(); }
+    char charAt(unsigned int index) const { return index < s_.size() ? s_[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    void trim();
+
+    String& operator+=(const String& rhs) { s_ += rhs.s_; return *this; }
+    String& operator+=(const char* rhs) { s_ += rhs; return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.s_ + rhs.s_); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.s_ + rhs); }
+    friend String operator+(const char* lhs, const String& rhs) { return String(lhs + rhs.s_); }
+
+    bool operator==(const String& rhs) const { return s_ == rhs.s_; }
+    bool operator==(const char* rhs) const { return s_ == rhs; }
+    bool operator!=(const String& rhs) const { return s_ != rhs.s_; }
+    bool operator!=(const char* rhs) const { return s_ != rhs; }
+
+private:
+    std::string s_;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return write(reinterpret_cast<const uint8_t*>(str), strlen(str)); }
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str) { return write(str.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(static_cast<unsigned int>(value), base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, digits)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    String readStringUntil(char terminator);
+};
+
+// Serial port backed by stdout. Input is whatever the host program injects.
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() { return 64; }
+    void flush();
+
+    int available() override;
+    int read() override;
+
+    // Host only: queue bytes as if they were typed into the serial monitor
+    void injectInput(const char* text);
+
+private:
+    std::mutex rxMutex_;
+    std::string rx_;
+};
+
+extern HostSerial Serial;
+
+#endif
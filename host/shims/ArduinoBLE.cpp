@@ -0,0 +1,263 @@
+#include "ArduinoBLE.h"
+
+#include <algorithm>
+#include <cctype>
+
+BLELocalDevice BLE;
+
+namespace blesim {
+
+namespace {
+
+bool uuidEquals(const std::string& a, const char* b) {
+    size_t n = strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; i++) {
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+struct Stack {
+    std::vector<Peripheral*> peripherals;
+    std::vector<Peripheral*> reported;
+    bool initialized = false;
+    bool scanning = false;
+    unsigned long scanStart = 0;
+    BLEDeviceEventHandler deviceHandlers[BLEDeviceLastEvent] = {};
+
+    static Stack& get() {
+        static Stack stack;
+        return stack;
+    }
+
+    static void deliver(Peripheral& p) {
+        // Handlers may queue further notifications, so swap the list out first
+        std::vector<Peripheral::PendingNotification> pending;
+        pending.swap(p.pending_);
+        for (auto& n : pending) {
+            Characteristic* c = n.characteristic;
+            c->value = n.data;
+            if (c->subscribed && c->handlers[BLEUpdated]) {
+                c->handlers[BLEUpdated](BLEDevice(&p), BLECharacteristic(c));
+            }
+        }
+    }
+
+    static void dropLink(Peripheral& p) {
+        p.linkDropped_ = false;
+        if (!p.connected_) return;
+        p.connected_ = false;
+        p.pending_.clear();
+        for (auto& s : p.services_) {
+            for (auto& c : s->characteristics) c->subscribed = false;
+        }
+        p.onDisconnect();
+        BLEDeviceEventHandler handler = get().deviceHandlers[BLEDisconnected];
+        if (handler) handler(BLEDevice(&p));
+    }
+};
+
+Peripheral::Peripheral(const char* address, const char* localName, int rssi)
+    : address_(address), localName_(localName ? localName : ""), rssi_(rssi) {}
+
+Peripheral::~Peripheral() {
+    unregisterPeripheral(this);
+}
+
+Service& Peripheral::addService(const char* uuid) {
+    services_.emplace_back(new Service());
+    services_.back()->uuid = uuid;
+    return *services_.back();
+}
+
+Characteristic& Peripheral::addCharacteristic(Service& service, const char* uuid, uint8_t properties) {
+    service.characteristics.emplace_back(new Characteristic());
+    Characteristic& c = *service.characteristics.back();
+    c.uuid = uuid;
+    c.properties = properties;
+    c.owner = this;
+    return c;
+}
+
+void Peripheral::notify(Characteristic& characteristic, const uint8_t* data, size_t length) {
+    if (!connected_ || !characteristic.subscribed) return;
+    pending_.push_back(PendingNotification{&characteristic, std::vector<uint8_t>(data, data + length)});
+}
+
+void Peripheral::dropLink() {
+    linkDropped_ = true;
+}
+
+void registerPeripheral(Peripheral* peripheral) {
+    Stack::get().peripherals.push_back(peripheral);
+}
+
+void unregisterPeripheral(Peripheral* peripheral) {
+    auto& list = Stack::get().peripherals;
+    list.erase(std::remove(list.begin(), list.end(), peripheral), list.end());
+    auto& reported = Stack::get().reported;
+    reported.erase(std::remove(reported.begin(), reported.end(), peripheral), reported.end());
+}
+
+} // namespace blesim
+
+using blesim::Stack;
+
+bool BLECharacteristic::subscribe() {
+    if (!c_ || !canSubscribe() || !c_->owner->isConnected()) return false;
+    c_->subscribed = true;
+    return true;
+}
+
+bool BLECharacteristic::unsubscribe() {
+    if (!c_ || !canSubscribe() || !c_->owner->isConnected()) return false;
+    c_->subscribed = false;
+    return true;
+}
+
+bool BLECharacteristic::read() {
+    return c_ && canRead() && c_->owner->isConnected();
+}
+
+int BLECharacteristic::writeValue(const uint8_t* value, int length) {
+    if (!c_ || !canWrite() || !c_->owner->isConnected() || length < 0) return 0;
+    delay(c_->owner->writeLatencyMs);
+    c_->value.assign(value, value + length);
+    c_->owner->onWrite(*c_, value, length);
+    return 1;
+}
+
+void BLECharacteristic::setEventHandler(int event, BLECharacteristicEventHandler handler) {
+    if (c_ && event >= 0 && event < BLECharacteristicEventLast) {
+        c_->handlers[event] = handler;
+    }
+}
+
+BLECharacteristic BLEService::characteristic(int index) const {
+    if (!s_ || index < 0 || index >= characteristicCount()) return BLECharacteristic();
+    return BLECharacteristic(s_->characteristics[index].get());
+}
+
+BLECharacteristic BLEService::characteristic(const char* uuid) const {
+    if (!s_) return BLECharacteristic();
+    for (auto& c : s_->characteristics) {
+        if (blesim::uuidEquals(c->uuid, uuid)) return BLECharacteristic(c.get());
+    }
+    return BLECharacteristic();
+}
+
+bool BLEDevice::connect() {
+    if (!p_ || p_->connected_) return p_ != nullptr;
+    delay(p_->connectLatencyMs);
+    if (!p_->inRange) return false;
+    p_->connected_ = true;
+    p_->linkDropped_ = false;
+    p_->onConnect();
+    BLEDeviceEventHandler handler = Stack::get().deviceHandlers[BLEConnected];
+    if (handler) handler(*this);
+    return true;
+}
+
+bool BLEDevice::disconnect() {
+    if (!p_ || !p_->connected_) return false;
+    Stack::dropLink(*p_);
+    return true;
+}
+
+bool BLEDevice::discoverAttributes() {
+    if (!p_ || !p_->connected_) return false;
+    delay(p_->discoveryLatencyMs);
+    return true;
+}
+
+int BLEDevice::serviceCount() const {
+    return p_ ? static_cast<int>(p_->services_.size()) : 0;
+}
+
+BLEService BLEDevice::service(int index) const {
+    if (!p_ || index < 0 || index >= serviceCount()) return BLEService();
+    return BLEService(p_->services_[index].get());
+}
+
+BLEService BLEDevice::service(const char* uuid) const {
+    if (!p_) return BLEService();
+    for (auto& s : p_->services_) {
+        if (blesim::uuidEquals(s->uuid, uuid)) return BLEService(s.get());
+    }
+    return BLEService();
+}
+
+BLECharacteristic BLEDevice::characteristic(const char* uuid) const {
+    if (!p_) return BLECharacteristic();
+    for (auto& s : p_->services_) {
+        BLECharacteristic c = BLEService(s.get()).characteristic(uuid);
+        if (c) return c;
+    }
+    return BLECharacteristic();
+}
+
+int BLELocalDevice::begin() {
+    Stack::get().initialized = true;
+    return 1;
+}
+
+void BLELocalDevice::end() {
+    Stack::get().initialized = false;
+}
+
+void BLELocalDevice::poll(unsigned long timeout) {
+    (void)timeout;
+    Stack& stack = Stack::get();
+    for (size_t i = 0; i < stack.peripherals.size(); i++) {
+        blesim::Peripheral& p = *stack.peripherals[i];
+        if (p.linkDropped_) {
+            Stack::dropLink(p);
+            continue;
+        }
+        if (!p.isConnected()) continue;
+        p.onPoll();
+        Stack::deliver(p);
+    }
+}
+
+int BLELocalDevice::scan(bool withDuplicates) {
+    (void)withDuplicates;
+    Stack& stack = Stack::get();
+    if (!stack.initialized) return 0;
+    stack.scanning = true;
+    stack.scanStart = millis();
+    stack.reported.clear();
+    return 1;
+}
+
+void BLELocalDevice::stopScan() {
+    Stack::get().scanning = false;
+}
+
+BLEDevice BLELocalDevice::available() {
+    Stack& stack = Stack::get();
+    if (!stack.scanning) return BLEDevice();
+    poll();
+    unsigned long elapsed = millis() - stack.scanStart;
+    for (blesim::Peripheral* p : stack.peripherals) {
+        if (p->isConnected() || !p->inRange || elapsed < p->advertiseDelayMs) continue;
+        if (std::find(stack.reported.begin(), stack.reported.end(), p) != stack.reported.end()) continue;
+        stack.reported.push_back(p);
+        BLEDevice device(p);
+        BLEDeviceEventHandler handler = stack.deviceHandlers[BLEDiscovered];
+        if (handler) handler(device);
+        return device;
+    }
+    return BLEDevice();
+}
+
+void BLELocalDevice::setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler handler) {
+    if (event >= 0 && event < BLEDeviceLastEvent) {
+        Stack::get().deviceHandlers[event] = handler;
+    }
+}
@@ -0,0 +1,211 @@
+#ifndef AXONA_HOST_ARDUINO_BLE_H
+#define AXONA_HOST_ARDUINO_BLE_H
+
+// Host stand-in for the central-role subset of ArduinoBLE used by BLEManager.
+//
+// Devices, services and characteristics are thin handles onto simulated
+// peripherals (see blesim::Peripheral). Notifications are delivered from
+// BLE.poll(), exactly like the real stack does on the Nano 33 BLE.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+#define BLEBroadcast 0x01
+#define BLERead 0x02
+#define BLEWriteWithoutResponse 0x04
+#define BLEWrite 0x08
+#define BLENotify 0x10
+#define BLEIndicate 0x20
+
+enum BLEDeviceEvent {
+    BLEConnected = 0,
+    BLEDisconnected,
+    BLEDiscovered,
+    BLEDeviceLastEvent
+};
+
+enum BLECharacteristicEvent {
+    BLESubscribed = 0,
+    BLEUnsubscribed,
+    BLEWritten = 3,
+    BLEUpdated,
+    BLECharacteristicEventLast
+};
+
+class BLEDevice;
+class BLECharacteristic;
+class BLELocalDevice;
+
+typedef void (*BLEDeviceEventHandler)(BLEDevice device);
+typedef void (*BLECharacteristicEventHandler)(BLEDevice device, BLECharacteristic characteristic);
+
+namespace blesim {
+
+class Peripheral;
+
+struct Characteristic {
+    std::string uuid;
+    uint8_t properties = 0;
+    std::vector<uint8_t> value;
+    bool subscribed = false;
+    BLECharacteristicEventHandler handlers[BLECharacteristicEventLast] = {};
+    Peripheral* owner = nullptr;
+};
+
+struct Service {
+    std::string uuid;
+    std::vector<std::unique_ptr<Characteristic>> characteristics;
+};
+
+// A simulated remote peripheral. Subclasses model device behaviour by
+// reacting to writes and producing notifications from onPoll().
+class Peripheral {
+public:
+    Peripheral(const char* address, const char* localName, int rssi);
+    virtual ~Peripheral();
+
+    Service& addService(const char* uuid);
+    Characteristic& addCharacteristic(Service& service, const char* uuid, uint8_t properties);
+
+    // Queue a notification; it is delivered on the next BLE.poll()
+    void notify(Characteristic& characteristic, const uint8_t* data, size_t length);
+
+    // Simulate the link going down (out of range, sensor reset, ...)
+    void dropLink();
+
+    virtual void onConnect() {}
+    virtual void onDisconnect() {}
+    virtual void onWrite(Characteristic& characteristic, const uint8_t* data, size_t length) {
+        (void)characteristic; (void)data; (void)length;
+    }
+    virtual void onPoll() {}
+
+    const std::string& address() const { return address_; }
+    const std::string& localName() const { return localName_; }
+    int rssi() const { return rssi_; }
+    bool isConnected() const { return connected_; }
+
+    // Simulated radio timing
+    unsigned long advertiseDelayMs = 50;
+    unsigned long connectLatencyMs = 30;
+    unsigned long discoveryLatencyMs = 40;
+    unsigned long writeLatencyMs = 8;
+    // Out of range: not advertising, and connection attempts fail
+    bool inRange = true;
+
+private:
+    friend class ::BLEDevice;
+    friend class ::BLECharacteristic;
+    friend class ::BLELocalDevice;
+    friend struct Stack;
+
+    struct PendingNotification {
+        Characteristic* characteristic;
+        std::vector<uint8_t> data;
+    };
+
+    std::string address_;
+    std::string localName_;
+    int rssi_;
+    bool connected_ = false;
+    bool linkDropped_ = false;
+    std::vector<std::unique_ptr<Service>> services_;
+    std::vector<PendingNotification> pending_;
+};
+
+void registerPeripheral(Peripheral* peripheral);
+void unregisterPeripheral(Peripheral* peripheral);
+
+} // namespace blesim
+
+class BLECharacteristic {
+public:
+    BLECharacteristic() {}
+    explicit BLECharacteristic(blesim::Characteristic* characteristic) : c_(characteristic) {}
+
+    explicit operator bool() const { return c_ != nullptr; }
+
+    const char* uuid() const { return c_ ? c_->uuid.c_str() : ""; }
+    uint8_t properties() const { return c_ ? c_->properties : 0; }
+    bool canRead() const { return properties() & BLERead; }
+    bool canWrite() const { return properties() & (BLEWrite | BLEWriteWithoutResponse); }
+    bool canSubscribe() const { return properties() & (BLENotify | BLEIndicate); }
+
+    bool subscribe();
+    bool unsubscribe();
+    bool subscribed() const { return c_ && c_->subscribed; }
+    bool read();
+    int writeValue(const uint8_t* value, int length);
+
+    const uint8_t* value() const { return c_ ? c_->value.data() : nullptr; }
+    int valueLength() const { return c_ ? static_cast<int>(c_->value.size()) : 0; }
+
+    void setEventHandler(int event, BLECharacteristicEventHandler handler);
+
+private:
+    blesim::Characteristic* c_ = nullptr;
+};
+
+class BLEService {
+public:
+    BLEService() {}
+    explicit BLEService(blesim::Service* service) : s_(service) {}
+
+    explicit operator bool() const { return s_ != nullptr; }
+
+    const char* uuid() const { return s_ ? s_->uuid.c_str() : ""; }
+    int characteristicCount() const { return s_ ? static_cast<int>(s_->characteristics.size()) : 0; }
+    BLECharacteristic characteristic(int index) const;
+    BLECharacteristic characteristic(const char* uuid) const;
+
+private:
+    blesim::Service* s_ = nullptr;
+};
+
+class BLEDevice {
+public:
+    BLEDevice() {}
+    explicit BLEDevice(blesim::Peripheral* peripheral) : p_(peripheral) {}
+
+    explicit operator bool() const { return p_ != nullptr; }
+    bool operator==(const BLEDevice& rhs) const { return p_ == rhs.p_; }
+    bool operator!=(const BLEDevice& rhs) const { return p_ != rhs.p_; }
+
+    String address() const { return p_ ? String(p_->address()) : String(); }
+    bool hasLocalName() const { return p_ && !p_->localName().empty(); }
+    String localName() const { return p_ ? String(p_->localName()) : String(); }
+    int rssi() const { return p_ ? p_->rssi() : 0; }
+
+    bool connect();
+    bool disconnect();
+    bool connected() const { return p_ && p_->connected_; }
+
+    bool discoverAttributes();
+    int serviceCount() const;
+    BLEService service(int index) const;
+    BLEService service(const char* uuid) const;
+    bool hasService(const char* uuid) const { return static_cast<bool>(service(uuid)); }
+    BLECharacteristic characteristic(const char* uuid) const;
+
+private:
+    blesim::Peripheral* p_ = nullptr;
+};
+
+class BLELocalDevice {
+public:
+    int begin();
+    void end();
+    void poll(unsigned long timeout = 0);
+
+    int scan(bool withDuplicates = false);
+    void stopScan();
+    BLEDevice available();
+
+    void setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler handler);
+};
+
+extern BLELocalDevice BLE;
+
+#endif
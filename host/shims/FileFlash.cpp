@@ -0,0 +1,84 @@
+#include "FileFlash.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+FileFlash::FileFlash(const std::string& path, uint32_t size, uint32_t pageSize, uint32_t programUnit)
+    : path_(path), size_(size), pageSize_(pageSize), programUnit_(programUnit),
+      eraseCounts_(pageSize ? size / pageSize : 0, 0) {}
+
+FileFlash::~FileFlash() {
+    if (image_) munmap(image_, size_);
+    if (fd_ >= 0) close(fd_);
+}
+
+bool FileFlash::open() {
+    if (image_) return true;
+    if (pageSize_ == 0 || size_ % pageSize_ != 0 || pageSize_ % programUnit_ != 0) return false;
+    
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) return false;
+    
+    struct stat st;
+    if (fstat(fd_, &st) != 0) return false;
+    const off_t existing = st.st_size;
+    if (existing < static_cast<off_t>(size_)) {
+        // New or short image: the missing part reads as erased flash
+        if (ftruncate(fd_, size_) != 0) return false;
+    }
+    
+    void* map = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) return false;
+    image_ = static_cast<uint8_t*>(map);
+    if (existing < static_cast<off_t>(size_)) {
+        std::memset(image_ + existing, 0xff, size_ - existing);
+    }
+    return true;
+}
+
+bool FileFlash::read(uint32_t address, void* data, uint32_t length) {
+    if (!image_ || powerLost_ || address > size_ || length > size_ - address) return false;
+    std::memcpy(data, image_ + address, length);
+    return true;
+}
+
+bool FileFlash::program(uint32_t address, const void* data, uint32_t length) {
+    if (!image_ || powerLost_ || address > size_ || length > size_ - address) return false;
+    if (address % programUnit_ != 0 || length % programUnit_ != 0) return false;
+    
+    uint32_t todo = length;
+    if (failArmed_ && failAfter_ < todo) {
+        todo = static_cast<uint32_t>(failAfter_);
+        powerLost_ = true;
+    }
+    
+    // NOR programming can only clear bits
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    for (uint32_t i = 0; i < todo; ++i) {
+        image_[address + i] &= src[i];
+    }
+    
+    if (failArmed_) failAfter_ -= todo;
+    bytesProgrammed_ += todo;
+    deviceBusyUs_ += FILE_FLASH_WORD_WRITE_US * ((todo + programUnit_ - 1) / programUnit_);
+    return !powerLost_;
+}
+
+bool FileFlash::erase(uint32_t address) {
+    if (!image_ || powerLost_ || address % pageSize_ != 0 || address >= size_) return false;
+    
+    if (failErase_) {
+        std::memset(image_ + address, 0xff, pageSize_ / 2);
+        powerLost_ = true;
+        return false;
+    }
+    
+    std::memset(image_ + address, 0xff, pageSize_);
+    pageErases_++;
+    eraseCounts_[address / pageSize_]++;
+    deviceBusyUs_ += FILE_FLASH_PAGE_ERASE_US;
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef AXONA_HOST_FILE_FLASH_H
+#define AXONA_HOST_FILE_FLASH_H
+
+// NOR flash stand-in backed by a memory-mapped file, so contents survive
+// across host runs like the nRF52840's internal flash survives resets.
+//
+// Enforces the NOR rules the firmware has to live with: erase sets a page
+// to 0xFF, program only clears bits and must be word aligned. For
+// power-loss testing it can cut the power part-way through a program or
+// erase; everything after that fails until restorePower(). It also keeps
+// a device-time estimate from the nRF52840 datasheet timings.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Flash.hpp"
+
+// nRF52840 NVMC timings (product specification, max)
+#define FILE_FLASH_WORD_WRITE_US 41.0
+#define FILE_FLASH_PAGE_ERASE_US 85000.0
+
+class FileFlash : public Flash {
+public:
+    FileFlash(const std::string& path, uint32_t size, uint32_t pageSize = 4096, uint32_t programUnit = 4);
+    ~FileFlash();
+    
+    FileFlash(const FileFlash&) = delete;
+    FileFlash& operator=(const FileFlash&) = delete;
+    
+    // Creates the file (erased) if needed and maps it
+    bool open();
+    
+    uint32_t size() const override { return size_; }
+    uint32_t pageSize() const override { return pageSize_; }
+    uint32_t programUnit() const override { return programUnit_; }
+    
+    bool read(uint32_t address, void* data, uint32_t length) override;
+    bool program(uint32_t address, const void* data, uint32_t length) override;
+    bool erase(uint32_t address) override;
+    
+    // Power cut after this many more programmed bytes; the interrupted
+    // program() writes only the bytes before the cut
+    void failAfterBytes(uint64_t bytes) { failAfter_ = bytes; failArmed_ = true; }
+    // Power cut in the middle of the next erase (first half erased only)
+    void failNextErase() { failErase_ = true; }
+    bool powerLost() const { return powerLost_; }
+    void restorePower() { powerLost_ = false; failArmed_ = false; failErase_ = false; }
+    
+    uint64_t bytesProgrammed() const { return bytesProgrammed_; }
+    uint64_t pageErases() const { return pageErases_; }
+    uint32_t eraseCount(uint32_t page) const { return eraseCounts_[page]; }
+    // Time the operations so far would have kept the nRF52840 busy
+    double deviceBusyUs() const { return deviceBusyUs_; }
+    
+private:
+    std::string path_;
+    uint32_t size_;
+    uint32_t pageSize_;
+    uint32_t programUnit_;
+    int fd_ = -1;
+    uint8_t* image_ = nullptr;
+    
+    bool failArmed_ = false;
+    uint64_t failAfter_ = 0;
+    bool failErase_ = false;
+    bool powerLost_ = false;
+    
+    uint64_t bytesProgrammed_ = 0;
+    uint64_t pageErases_ = 0;
+    double deviceBusyUs_ = 0;
+    std::vector<uint32_t> eraseCounts_;
+};
+
+#endif
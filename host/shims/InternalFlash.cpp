@@ -0,0 +1,49 @@
+// Host implementation of InternalFlash: the nRF52840's 1 MiB of internal
+// flash as a file-backed image, axona_flash.bin in the working directory
+// unless AXONA_FLASH_FILE names another file.
+
+#include "InternalFlash.hpp"
+
+#include <cstdlib>
+#include "FileFlash.hpp"
+
+namespace {
+
+const uint32_t NRF52840_FLASH_SIZE = 1024 * 1024;
+
+FileFlash& image() {
+    static FileFlash flash(getenv("AXONA_FLASH_FILE") ? getenv("AXONA_FLASH_FILE") : "axona_flash.bin",
+                           NRF52840_FLASH_SIZE, INTERNAL_FLASH_PAGE_SIZE, INTERNAL_FLASH_PROGRAM_UNIT);
+    return flash;
+}
+
+} // namespace
+
+bool InternalFlash::begin() {
+    if (!image().open()) return false;
+    if (size_ == 0 || size_ % INTERNAL_FLASH_PAGE_SIZE != 0 || endOffset_ % INTERNAL_FLASH_PAGE_SIZE != 0 ||
+        size_ + endOffset_ > NRF52840_FLASH_SIZE) {
+        return false;
+    }
+    base_ = NRF52840_FLASH_SIZE - endOffset_ - size_;
+    started_ = true;
+    return true;
+}
+
+bool InternalFlash::read(uint32_t address, void* data, uint32_t length) {
+    if (!inRange(address, length)) return false;
+    return image().read(base_ + address, data, length);
+}
+
+// Same argument checks as the target implementation, so alignment bugs in
+// the callers fail on the host too
+bool InternalFlash::program(uint32_t address, const void* data, uint32_t length) {
+    if (!inRange(address, length)) return false;
+    if (address % INTERNAL_FLASH_PROGRAM_UNIT != 0 || length % INTERNAL_FLASH_PROGRAM_UNIT != 0) return false;
+    return image().program(base_ + address, data, length);
+}
+
+bool InternalFlash::erase(uint32_t address) {
+    if (!inRange(address, INTERNAL_FLASH_PAGE_SIZE) || address % INTERNAL_FLASH_PAGE_SIZE != 0) return false;
+    return image().erase(base_ + address);
+}
@@ -0,0 +1,129 @@
+#include "MovesenseSim.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+const float G = 9.81f;
+const float PI_F = 3.14159265f;
+
+void putU32(std::vector<uint8_t>& out, size_t offset, uint32_t v) {
+    memcpy(out.data() + offset, &v, sizeof(v));
+}
+
+void putF32(std::vector<uint8_t>& out, size_t offset, float v) {
+    memcpy(out.data() + offset, &v, sizeof(v));
+}
+
+} // namespace
+
+MovesenseSim::MovesenseSim(const char* address, int rssi)
+    : blesim::Peripheral(address, "Movesense 000000000000", rssi) {
+    addService("1800");
+    addService("1801");
+    addService("180a");
+    addService("180f");
+    addService("fdf3");
+    blesim::Service& gsp = addService(MOVESENSE_GSP_SERVICE_UUID);
+    writeChar_ = &addCharacteristic(gsp, MOVESENSE_GSP_WRITE_UUID, BLEWrite | BLEWriteWithoutResponse);
+    notifyChar_ = &addCharacteristic(gsp, MOVESENSE_GSP_NOTIFY_UUID, BLENotify);
+}
+
+std::vector<uint8_t> MovesenseSim::encodeIMU6(uint8_t reference, uint32_t timestamp,
+                                              const float* acc, const float* gyro, int rows) {
+    std::vector<uint8_t> packet(6 + 2 * 12 * rows);
+    packet[0] = 2;
+    packet[1] = reference;
+    putU32(packet, 2, timestamp);
+    for (int i = 0; i < rows; i++) {
+        for (int k = 0; k < 3; k++) {
+            putF32(packet, 6 + i * 12 + k * 4, acc[3 * i + k]);
+            putF32(packet, 6 + rows * 12 + i * 12 + k * 4, gyro[3 * i + k]);
+        }
+    }
+    return packet;
+}
+
+void MovesenseSim::scheduleImpact(unsigned long atMs, float peakG, float durationMs) {
+    impacts_.push_back(Impact{atMs, peakG, durationMs});
+}
+
+void MovesenseSim::onDisconnect() {
+    rate_ = 0;
+}
+
+void MovesenseSim::onWrite(blesim::Characteristic& characteristic, const uint8_t* data, size_t length) {
+    if (&characteristic != writeChar_ || length < 2) return;
+
+    // GSP request: [command][reference][path...]
+    uint8_t command = data[0];
+    if (command == 1) {
+        std::string path(reinterpret_cast<const char*>(data + 2), length - 2);
+        const std::string prefix = "/Meas/IMU6/";
+        if (path.compare(0, prefix.size(), prefix) != 0) return;
+        int rate = atoi(path.c_str() + prefix.size());
+        if (rate <= 0) return;
+        rate_ = rate;
+        reference_ = data[1];
+        streamStart_ = millis();
+        samplesSent_ = 0;
+        // The sensor clock keeps running across resubscriptions
+        if (!subscribedBefore_) {
+            firstStreamStart_ = streamStart_;
+            subscribedBefore_ = true;
+        }
+    } else if (command == 2) {
+        // A new subscription has already replaced the stream of an older reference
+        if (data[1] == reference_) {
+            rate_ = 0;
+        }
+    }
+}
+
+void MovesenseSim::onPoll() {
+    if (rate_ <= 0) return;
+
+    // 13 Hz per row up to 104 Hz; higher rates send 8-row packets more often
+    int rowsPerPacket = rate_ / 13 > 0 ? rate_ / 13 : 1;
+    if (rowsPerPacket > MOVESENSE_SIM_MAX_ROWS) rowsPerPacket = MOVESENSE_SIM_MAX_ROWS;
+    const unsigned long elapsed = millis() - streamStart_;
+
+    while ((samplesSent_ + rowsPerPacket) * 1000UL <= elapsed * static_cast<unsigned long>(rate_)) {
+        const double t0 = (streamStart_ - firstStreamStart_) + samplesSent_ * 1000.0 / rate_;
+
+        std::vector<float> acc(3 * rowsPerPacket), gyro(3 * rowsPerPacket);
+        for (int i = 0; i < rowsPerPacket; i++) {
+            sampleAt(t0 + i * 1000.0 / rate_, &acc[3 * i], &gyro[3 * i]);
+        }
+
+        std::vector<uint8_t> packet = encodeIMU6(reference_, sensorClockOffset_ + static_cast<uint32_t>(t0),
+                                                 acc.data(), gyro.data(), rowsPerPacket);
+        notify(*notifyChar_, packet.data(), packet.size());
+        samplesSent_ += rowsPerPacket;
+    }
+}
+
+void MovesenseSim::sampleAt(double tMs, float* acc, float* gyro) {
+    acc[0] = noise() * 0.05f;
+    acc[1] = noise() * 0.05f;
+    acc[2] = G + noise() * 0.05f;
+    for (const Impact& impact : impacts_) {
+        double dt = tMs - impact.atMs;
+        if (dt >= 0.0 && dt <= impact.durationMs) {
+            acc[0] += impact.peakG * G * static_cast<float>(std::sin(PI_F * dt / impact.durationMs));
+        }
+    }
+    for (int k = 0; k < 3; k++) {
+        gyro[k] = noise() * 0.01f;
+    }
+}
+
+float MovesenseSim::noise() {
+    // xorshift32, deterministic across runs
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return (rng_ / 4294967295.0f) * 2.0f - 1.0f;
+}
@@ -0,0 +1,62 @@
+#ifndef AXONA_HOST_MOVESENSE_SIM_H
+#define AXONA_HOST_MOVESENSE_SIM_H
+
+#include <ArduinoBLE.h>
+#include <vector>
+
+#define MOVESENSE_GSP_SERVICE_UUID "34802252-7185-4d5d-b431-630e7050e8f0"
+#define MOVESENSE_GSP_WRITE_UUID "34800001-7185-4d5d-b431-630e7050e8f0"
+#define MOVESENSE_GSP_NOTIFY_UUID "34800002-7185-4d5d-b431-630e7050e8f0"
+#define MOVESENSE_SIM_MAX_ROWS 8
+
+// Simulated Movesense Flash sensor speaking the GATT Sensor Protocol (GSP).
+//
+// The GSP service sits at index 5 with the write characteristic at 0 and
+// the notify characteristic at 1, as on the real sensor. The firmware finds
+// them by UUID; the indices matter for the index-based serial commands.
+// A "/Meas/IMU6/<rate>" subscription streams a stationary, Z-up sensor with
+// a little noise plus any impacts that were scheduled. Subscribing again,
+// under any reference, moves the one stream to the new rate on the same
+// sensor clock.
+class MovesenseSim : public blesim::Peripheral {
+public:
+    MovesenseSim(const char* address, int rssi = -60);
+
+    // Half-sine acceleration pulse along X, atMs relative to the first subscription
+    void scheduleImpact(unsigned long atMs, float peakG, float durationMs);
+
+    int streamRate() const { return rate_; }
+
+    // Encode an IMU6 notification: header, then rows of acc xyz, then rows of gyro xyz
+    static std::vector<uint8_t> encodeIMU6(uint8_t reference, uint32_t timestamp,
+                                           const float* acc, const float* gyro, int rows);
+
+    void onDisconnect() override;
+    void onWrite(blesim::Characteristic& characteristic, const uint8_t* data, size_t length) override;
+    void onPoll() override;
+
+private:
+    struct Impact {
+        unsigned long atMs;
+        float peakG;
+        float durationMs;
+    };
+
+    void sampleAt(double tMs, float* acc, float* gyro);
+    float noise();
+
+    blesim::Characteristic* writeChar_;
+    blesim::Characteristic* notifyChar_;
+    std::vector<Impact> impacts_;
+
+    int rate_ = 0;
+    uint8_t reference_ = 0;
+    unsigned long streamStart_ = 0;
+    unsigned long firstStreamStart_ = 0;
+    bool subscribedBefore_ = false;
+    unsigned long samplesSent_ = 0;
+    uint32_t sensorClockOffset_ = 123456;
+    uint32_t rng_ = 0x2545F491;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "RideSim.hpp"
+
+#include <cmath>
+
+namespace {
+
+const double G = 9.81;
+const double PI = 3.14159265358979323846;
+
+void normalize(double* q) {
+    double n = std::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    for (int i = 0; i < 4; i++) q[i] /= n;
+}
+
+// v_body = R(q)^T v_world
+void worldToBody(const double* q, const double* v, double* out) {
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    out[0] = (1 - 2*(y*y + z*z)) * v[0] + 2*(x*y + w*z) * v[1] + 2*(x*z - w*y) * v[2];
+    out[1] = 2*(x*y - w*z) * v[0] + (1 - 2*(x*x + z*z)) * v[1] + 2*(y*z + w*x) * v[2];
+    out[2] = 2*(x*z + w*y) * v[0] + 2*(y*z - w*x) * v[1] + (1 - 2*(x*x + y*y)) * v[2];
+}
+
+} // namespace
+
+RideSim::RideSim(int rateHz, uint32_t seed)
+    : rateHz_(rateHz), rng_(seed ? seed : 1) {}
+
+void RideSim::scheduleImpact(uint32_t atMs, float peakG, float durationMs) {
+    impacts_.push_back(Impact{atMs, peakG, durationMs});
+}
+
+void RideSim::bodyRate(double t, double* w) const {
+    w[0] = motion_ * 0.30 * std::sin(0.7 * t);
+    w[1] = motion_ * 0.20 * std::sin(1.3 * t + 0.5);
+    w[2] = motion_ * 0.50 * std::sin(0.4 * t + 1.0);
+}
+
+RideSample RideSim::next() {
+    const double dt = 1.0 / rateHz_;
+    const double tNow = index_ * dt;
+
+    // Integrate the true attitude up to tNow with fine sub-steps
+    const int subSteps = 16;
+    while (t_ + 1e-12 < tNow) {
+        double h = (tNow - t_) < dt / subSteps ? (tNow - t_) : dt / subSteps;
+        double w[3];
+        bodyRate(t_ + h / 2, w);
+        const double* q = q_;
+        double dq[4] = {
+            -0.5 * (q[1]*w[0] + q[2]*w[1] + q[3]*w[2]),
+             0.5 * (q[0]*w[0] + q[2]*w[2] - q[3]*w[1]),
+             0.5 * (q[0]*w[1] - q[1]*w[2] + q[3]*w[0]),
+             0.5 * (q[0]*w[2] + q[1]*w[1] - q[2]*w[0]),
+        };
+        for (int i = 0; i < 4; i++) q_[i] += dq[i] * h;
+        normalize(q_);
+        t_ += h;
+    }
+
+    RideSample s;
+    s.timestamp = static_cast<uint32_t>(std::lround(tNow * 1000.0));
+    s.timestampUs = static_cast<uint32_t>(std::llround(tNow * 1000000.0));
+
+    const double up[3] = {0.0, 0.0, 1.0};
+    worldToBody(q_, up, s.gravity);
+
+    // Gentle fore/aft acceleration in the world frame, plus impacts in the sensor frame
+    const double aWorld[3] = {motion_ * 0.8 * std::sin(0.25 * tNow), 0.0, 0.0};
+    worldToBody(q_, aWorld, s.linearAcc);
+    for (const Impact& impact : impacts_) {
+        double since = tNow * 1000.0 - impact.atMs;
+        if (since >= 0.0 && since <= impact.durationMs) {
+            s.linearAcc[0] += impact.peakG * G * std::sin(PI * since / impact.durationMs);
+        }
+    }
+
+    double w[3];
+    bodyRate(tNow, w);
+    for (int k = 0; k < 3; k++) {
+        s.acc[k] = static_cast<float>(s.gravity[k] * G + s.linearAcc[k]) + noise() * accNoise_;
+        s.gyro[k] = static_cast<float>(w[k]) + noise() * gyroNoise_;
+    }
+
+    index_++;
+    return s;
+}
+
+float RideSim::noise() {
+    // xorshift32, deterministic across runs
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return (rng_ / 4294967295.0f) * 2.0f - 1.0f;
+}
@@ -0,0 +1,55 @@
+#ifndef AXONA_HOST_RIDE_SIM_H
+#define AXONA_HOST_RIDE_SIM_H
+
+#include <cstdint>
+#include <vector>
+
+// One synthetic helmet sample plus its ground truth
+struct RideSample {
+    uint32_t timestamp;     // ms, as in the IMU6 packets
+    uint32_t timestampUs;   // the same instant in µs, as IMUProcessor takes it
+    float acc[3];           // specific force in the sensor frame, m/s²
+    float gyro[3];          // body rates as the firmware interprets them, rad/s
+    double gravity[3];      // true unit gravity direction in the sensor frame
+    double linearAcc[3];    // true linear acceleration in the sensor frame, m/s²
+};
+
+// Deterministic synthetic ride: head motion as a sum of slow sinusoidal
+// body rates, gentle fore/aft acceleration, sensor noise and scheduled
+// half-sine impacts. The true attitude is integrated with fine sub-steps
+// so filters can be scored against it.
+class RideSim {
+public:
+    explicit RideSim(int rateHz, uint32_t seed = 1);
+
+    // Half-sine acceleration pulse along sensor X at atMs
+    void scheduleImpact(uint32_t atMs, float peakG, float durationMs);
+    // Scale of the head motion (0 = perfectly still)
+    void setMotion(double scale) { motion_ = scale; }
+    void setNoise(float accNoise, float gyroNoise) { accNoise_ = accNoise; gyroNoise_ = gyroNoise; }
+
+    RideSample next();
+    int rateHz() const { return rateHz_; }
+
+private:
+    struct Impact {
+        uint32_t atMs;
+        float peakG;
+        float durationMs;
+    };
+
+    void bodyRate(double t, double* w) const;
+    float noise();
+
+    int rateHz_;
+    uint64_t index_ = 0;
+    double motion_ = 1.0;
+    float accNoise_ = 0.05f;
+    float gyroNoise_ = 0.005f;
+    double q_[4] = {1.0, 0.0, 0.0, 0.0};  // body -> world
+    double t_ = 0.0;
+    uint32_t rng_;
+    std::vector<Impact> impacts_;
+};
+
+#endif
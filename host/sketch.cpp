@@ -0,0 +1,2 @@
+// Compiles the unmodified Arduino sketch as a host translation unit
+#include "../axona-app.ino"
@@ -0,0 +1,129 @@
+#include "TelemetryDecoder.hpp"
+
+#include <cstring>
+
+#include "Cobs.hpp"
+#include "Crc32.hpp"
+#include "Telemetry.hpp"
+
+namespace telemetry {
+
+namespace {
+
+uint32_t get32(const uint8_t* p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+
+float getFloat(const uint8_t* p) {
+    uint32_t bits = get32(p);
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+} // namespace
+
+void Decoder::feed(const uint8_t* data, size_t length) {
+    counters_.bytes += length;
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != 0) {
+            // Bound the garbage kept while waiting for a delimiter
+            if (pending_.size() < TELEMETRY_MAX_FRAME) {
+                pending_.push_back(data[i]);
+            } else {
+                pending_.clear();
+                synced_ = false;
+            }
+            continue;
+        }
+        // Bytes before the first delimiter are a partial frame, not an error
+        if (synced_ && !pending_.empty()) frame(pending_.data(), pending_.size());
+        pending_.clear();
+        synced_ = true;
+    }
+}
+
+void Decoder::frame(uint8_t* data, size_t length) {
+    size_t size = cobsDecode(data, length, data);
+    if (size < 6) {
+        counters_.invalidFrames++;
+        return;
+    }
+    if (crc32(data, size - 4) != get32(data + size - 4)) {
+        counters_.invalidFrames++;
+        return;
+    }
+
+    const uint8_t type = data[0];
+    const uint8_t sequence = data[1];
+    if (!dispatch(type, sequence, data + 2, size - 6)) return;
+
+    counters_.frames++;
+    if (haveSequence_) counters_.sequenceGaps += uint8_t(sequence - lastSequence_ - 1);
+    lastSequence_ = sequence;
+    haveSequence_ = true;
+}
+
+bool Decoder::dispatch(uint8_t type, uint8_t sequence, const uint8_t* p, size_t length) {
+    switch (type) {
+        case TELEMETRY_SAMPLES: {
+            if (length < TELEMETRY_SAMPLES_HEADER_SIZE) break;
+            IMU6Packet packet;
+            const uint8_t* raw = p + TELEMETRY_SAMPLES_HEADER_SIZE;
+            const size_t rawLength = length - TELEMETRY_SAMPLES_HEADER_SIZE;
+            if (decodeIMU6Packet(raw, rawLength, packet) != IMU6Status::OK) break;
+            SamplesRecord r;
+            r.sequence = sequence;
+            r.device = p[0];
+            r.arrivalUs = get32(p + 1);
+            r.payload = raw;
+            r.length = rawLength;
+            r.timestamp = packet.timestamp;
+            r.sampleRate = uint16_t(packet.sampleRate);
+            r.rows.resize(packet.numRows);
+            uint32_t timestamps[IMU6_MAX_ROWS];
+            clocks_[r.device].stamp(packet, timestamps);
+            for (int i = 0; i < packet.numRows; ++i) {
+                uint32_t nominalUs;
+                packet.readRow(i, r.rows[i].acc, r.rows[i].gyro, nominalUs);
+                r.rows[i].timestampUs = timestamps[i];
+            }
+            if (onSamples) onSamples(r);
+            return true;
+        }
+        case TELEMETRY_IMPACT: {
+            if (length != TELEMETRY_IMPACT_SIZE) break;
+            ImpactRecord r;
+            r.sequence = sequence;
+            r.device = p[0];
+            r.triggerTime = get32(p + 1);
+            r.receiverUs = get32(p + 5);
+            r.level = p[9];
+            r.hic15 = getFloat(p + 10);
+            r.hic36 = getFloat(p + 14);
+            r.peakAcc = getFloat(p + 18);
+            r.ridingVelocity = getFloat(p + 22);
+            r.headVelocity = getFloat(p + 26);
+            if (onImpact) onImpact(r);
+            return true;
+        }
+        case TELEMETRY_STATS: {
+            if (length != TELEMETRY_STATS_SIZE) break;
+            StatsRecord r;
+            r.sequence = sequence;
+            r.uptimeMs = get32(p);
+            r.samplesPushed = get32(p + 4);
+            r.samplesDropped = get32(p + 8);
+            r.queueHighWater = get32(p + 12);
+            r.framesDropped = get32(p + 16);
+            r.eventLogRecords = get32(p + 20);
+            if (onStats) onStats(r);
+            return true;
+        }
+        default:
+            counters_.unknownFrames++;
+            return false;
+    }
+    counters_.invalidFrames++;
+    return false;
+}
+
+} // namespace telemetry
@@ -0,0 +1,92 @@
+// Host-side decoder for the firmware's binary serial telemetry (src/Telemetry.hpp).
+//
+// Feed it the raw serial byte stream in chunks of any size; every complete,
+// CRC-valid frame is dispatched to the matching callback. Anything else on
+// the line, such as the text the sketch prints before it starts streaming,
+// ends up in an invalid frame and is counted, never delivered. Sample rows
+// are timed per device by a SampleClock, as in the firmware's pipelines.
+
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "SampleClock.hpp"
+
+namespace telemetry {
+
+struct SampleRow {
+    uint32_t timestampUs;           // sensor clock
+    float acc[3];
+    float gyro[3];
+};
+
+struct SamplesRecord {
+    uint8_t sequence;
+    uint8_t device;
+    uint32_t arrivalUs;             // device micros() when the notification arrived
+    const uint8_t* payload;         // the IMU6 notification as received, valid during the callback
+    size_t length;
+    uint32_t timestamp;             // sensor clock of the first row, ms
+    uint16_t sampleRate;            // nominal, 13 Hz per row (see decodeIMU6Packet)
+    std::vector<SampleRow> rows;
+};
+
+struct ImpactRecord {
+    uint8_t sequence;
+    uint8_t device;
+    uint32_t triggerTime;           // sensor clock, µs
+    uint32_t receiverUs;            // trigger on the receiver's micros()
+    uint8_t level;
+    float hic15;
+    float hic36;
+    float peakAcc;
+    float ridingVelocity;
+    float headVelocity;
+};
+
+struct StatsRecord {
+    uint8_t sequence;
+    uint32_t uptimeMs;
+    uint32_t samplesPushed;
+    uint32_t samplesDropped;
+    uint32_t queueHighWater;
+    uint32_t framesDropped;
+    uint32_t eventLogRecords;
+};
+
+class Decoder {
+public:
+    struct Counters {
+        uint64_t bytes = 0;
+        uint64_t frames = 0;          // valid frames of any type
+        uint64_t invalidFrames = 0;   // bad COBS, CRC or length
+        uint64_t unknownFrames = 0;   // valid CRC, unknown record type
+        uint64_t sequenceGaps = 0;    // frames lost between two valid ones
+    };
+
+    std::function<void(const SamplesRecord&)> onSamples;
+    std::function<void(const ImpactRecord&)> onImpact;
+    std::function<void(const StatsRecord&)> onStats;
+
+    void feed(const uint8_t* data, size_t length);
+    const Counters& counters() const { return counters_; }
+
+private:
+    void frame(uint8_t* data, size_t length);
+    bool dispatch(uint8_t type, uint8_t sequence, const uint8_t* payload, size_t length);
+
+    std::vector<uint8_t> pending_;
+    bool synced_ = false;
+    bool haveSequence_ = false;
+    uint8_t lastSequence_ = 0;
+    Counters counters_;
+    SampleClock clocks_[256];       // by device
+};
+
+} // namespace telemetry
+
+#endif
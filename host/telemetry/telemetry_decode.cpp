@@ -0,0 +1,55 @@
+// Decodes a binary telemetry capture into CSV, one line per record.
+//
+//   telemetry_decode [file]        reads stdin when no file is given
+//
+//   samples,<seq>,<device>,<timestamp us>,<accX>,<accY>,<accZ>,<gyroX>,<gyroY>,<gyroZ>   (one per row)
+//   impact,<seq>,<device>,<trigger us>,<receiver us>,<level>,<hic15>,<hic36>,<peakAcc>,<ridingVelocity>,<headVelocity>
+//   stats,<seq>,<uptime ms>,<pushed>,<dropped>,<queueHighWater>,<framesDropped>,<eventLogRecords>
+//
+// Frame counters go to stderr at the end.
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "TelemetryDecoder.hpp"
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    telemetry::Decoder decoder;
+    decoder.onSamples = [](const telemetry::SamplesRecord& r) {
+        for (size_t i = 0; i < r.rows.size(); ++i) {
+            const telemetry::SampleRow& row = r.rows[i];
+            printf("samples,%u,%u,%" PRIu32 ",%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n", r.sequence, r.device, row.timestampUs,
+                   row.acc[0], row.acc[1], row.acc[2], row.gyro[0], row.gyro[1], row.gyro[2]);
+        }
+    };
+    decoder.onImpact = [](const telemetry::ImpactRecord& r) {
+        printf("impact,%u,%u,%" PRIu32 ",%" PRIu32 ",%u,%.2f,%.2f,%.2f,%.2f,%.2f\n", r.sequence, r.device,
+               r.triggerTime, r.receiverUs, r.level,
+               r.hic15, r.hic36, r.peakAcc, r.ridingVelocity, r.headVelocity);
+    };
+    decoder.onStats = [](const telemetry::StatsRecord& r) {
+        printf("stats,%u,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n", r.sequence,
+               r.uptimeMs, r.samplesPushed, r.samplesDropped, r.queueHighWater, r.framesDropped, r.eventLogRecords);
+    };
+
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        decoder.feed(buffer, n);
+    }
+    if (in != stdin) fclose(in);
+
+    const telemetry::Decoder::Counters& c = decoder.counters();
+    fprintf(stderr, "%" PRIu64 " bytes, %" PRIu64 " frames, %" PRIu64 " invalid, %" PRIu64 " unknown, %" PRIu64 " lost\n",
+            c.bytes, c.frames, c.invalidFrames, c.unknownFrames, c.sequenceGaps);
+    return 0;
+}
@@ -0,0 +1,111 @@
+// computeHIC against a brute-force reference: every pair of samples within
+// the window, each average summed from scratch in double precision.
+//
+// Random pulses on jittered timestamps with occasional gaps, including
+// windows across the 32-bit wrap. The fast search must find the same
+// maximum within HIC_TOLERANCE (relative), and computeHICStep run in
+// slices must give exactly what computeHIC gives. Exits non-zero on the
+// first failure.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "ImpactMetrics.hpp"
+
+namespace {
+
+#ifdef AXONA_DOUBLE_PRECISION
+const double HIC_TOLERANCE = 1e-9;
+#else
+const double HIC_TOLERANCE = 1e-4;
+#endif
+const int WINDOWS = 2000;
+const size_t SAMPLES = 200;
+
+struct Reference {
+    double hic15 = 0;
+    double hic36 = 0;
+};
+
+Reference bruteForce(const SampleBuffer& buffer, SampleWindow window, double shortMs, double longMs) {
+    Reference r;
+    for (size_t i = window.begin; i < window.end; ++i) {
+        for (size_t j = i + 1; j < window.end; ++j) {
+            const double dtMs = static_cast<uint32_t>(buffer.timestamp(j) - buffer.timestamp(i)) / 1000.0;
+            if (dtMs > longMs) break;
+            double sum = 0;
+            for (size_t k = i; k <= j; ++k) {
+                sum += static_cast<double>(buffer.linAcc(k)) / G_CONSTANT;
+            }
+            const double avg = sum / (j - i + 1);
+            const double hic = dtMs / 1000.0 * std::pow(avg, 2.5);
+            r.hic36 = std::max(r.hic36, hic);
+            if (dtMs <= shortMs) r.hic15 = std::max(r.hic15, hic);
+        }
+    }
+    return r;
+}
+
+bool close(double actual, double expected) {
+    return std::fabs(actual - expected) <= HIC_TOLERANCE * std::max(1.0, std::fabs(expected));
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    static StaticSampleBuffer<SAMPLES> buffer;
+    double worst = 0;
+
+    for (int w = 0; w < WINDOWS; ++w) {
+        buffer.clear();
+        // Every tenth window straddles the 32-bit wrap
+        uint32_t t = w % 10 == 0 ? UINT32_MAX - 50000u : static_cast<uint32_t>(rng());
+        const double stepUs = 1000000.0 / (100 + 900 * unit(rng));
+        const double peakG = 5 + 150 * unit(rng);
+        const double widthMs = 2 + 30 * unit(rng);
+        const double centreMs = 20 + 100 * unit(rng);
+        const uint32_t start = t;
+
+        for (size_t i = 0; i < SAMPLES; ++i) {
+            IMUData d = {};
+            d.timestamp = t;
+            const double ms = static_cast<uint32_t>(t - start) / 1000.0;
+            const double pulse = std::exp(-0.5 * std::pow((ms - centreMs) / (widthMs / 2), 2));
+            d.linAcc = static_cast<Scalar>((peakG * pulse + 0.5 * unit(rng)) * G_CONSTANT);
+            buffer.push(d);
+            double step = stepUs * (0.9 + 0.2 * unit(rng));
+            if (unit(rng) < 0.02) step *= 10;  // a gap
+            t += static_cast<uint32_t>(step);
+        }
+
+        SampleWindow window;
+        window.begin = static_cast<size_t>(unit(rng) * SAMPLES / 4);
+        window.end = SAMPLES - static_cast<size_t>(unit(rng) * SAMPLES / 4);
+
+        const HICResult fast = computeHIC(buffer, window);
+        const Reference ref = bruteForce(buffer, window, HIC15_WINDOW_MS, HIC36_WINDOW_MS);
+        if (!close(fast.hic15, ref.hic15) || !close(fast.hic36, ref.hic36)) {
+            fprintf(stderr, "window %d: hic15 %.9g / %.9g, hic36 %.9g / %.9g (fast / reference)\n", w,
+                    static_cast<double>(fast.hic15), ref.hic15, static_cast<double>(fast.hic36), ref.hic36);
+            return 1;
+        }
+        worst = std::max(worst, std::fabs(fast.hic36 - ref.hic36) / std::max(1.0, ref.hic36));
+
+        HICResult sliced;
+        for (size_t next = window.begin; next + 1 < window.end;) {
+            next = computeHICStep(buffer, window, next, 1 + w % 7, S(HIC15_WINDOW_MS), S(HIC36_WINDOW_MS), sliced);
+        }
+        if (sliced.hic15 != fast.hic15 || sliced.hic36 != fast.hic36) {
+            fprintf(stderr, "window %d: sliced search differs from computeHIC\n", w);
+            return 1;
+        }
+    }
+
+    printf("%d windows, worst relative error %.3g (tolerance %.3g)\n", WINDOWS, worst, HIC_TOLERANCE);
+    return 0;
+}
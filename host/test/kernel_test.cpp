@@ -0,0 +1,93 @@
+// Every dispatching batch kernel against its scalar reference in
+// kernels::reference, for lengths 0 to 67 (all SIMD tail lengths) and
+// unaligned arrays. Each output must be within KERNEL_TOLERANCE (relative,
+// against a magnitude of at least 1) of the reference. Exits non-zero on
+// the first failure.
+//
+// The float core checks the path this host dispatches to (SSE, NEON or
+// the portable one); the double core checks the portable path.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Kernels.hpp"
+
+namespace {
+
+#ifdef AXONA_DOUBLE_PRECISION
+const double KERNEL_TOLERANCE = 1e-12;
+#else
+const double KERNEL_TOLERANCE = 1e-6;
+#endif
+const size_t MAX_LENGTH = 67;
+
+int failures = 0;
+
+void check(const char* kernel, size_t n, const Scalar* fast, const Scalar* ref, double& worst) {
+    for (size_t i = 0; i < n; ++i) {
+        const double diff = std::fabs(double(fast[i]) - double(ref[i])) / std::max(1.0, std::fabs(double(ref[i])));
+        worst = std::max(worst, diff);
+        if (diff > KERNEL_TOLERANCE && failures++ == 0) {
+            fprintf(stderr, "%s n=%zu [%zu]: %.9g, reference %.9g\n", kernel, n, i, double(fast[i]), double(ref[i]));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> accDist(-160.0f, 160.0f);
+    std::uniform_real_distribution<float> dtDist(0.0009f, 0.04f);
+    double worst[4] = {};
+
+    // One element of slack, so the arrays can start off their alignment
+    std::vector<float> xyz(3 * MAX_LENGTH + 1);
+    std::vector<Scalar> x(MAX_LENGTH + 1), y(MAX_LENGTH + 1), z(MAX_LENGTH + 1), dt(MAX_LENGTH + 1);
+    std::vector<Scalar> fast(MAX_LENGTH + 1), ref(MAX_LENGTH + 1);
+
+    for (int round = 0; round < 50; ++round) {
+        for (size_t n = 0; n <= MAX_LENGTH; ++n) {
+            const size_t o = (round + n) % 2;
+            for (float& v : xyz) v = accDist(rng);
+            for (Scalar& v : dt) v = dtDist(rng);
+
+            kernels::deinterleave3(xyz.data() + o, x.data() + o, y.data() + o, z.data() + o, n);
+            for (size_t i = 0; i < n; ++i) {
+                if (x[o + i] != Scalar(xyz[o + 3 * i]) || y[o + i] != Scalar(xyz[o + 3 * i + 1]) ||
+                    z[o + i] != Scalar(xyz[o + 3 * i + 2])) {
+                    if (failures++ == 0) fprintf(stderr, "deinterleave3 n=%zu [%zu] differs\n", n, i);
+                }
+            }
+
+            const Scalar c = static_cast<Scalar>(accDist(rng) / 16);
+            kernels::offset(x.data() + o, c, fast.data() + o, n);
+            kernels::reference::offset(x.data() + o, c, ref.data() + o, n);
+            check("offset", n, fast.data() + o, ref.data() + o, worst[0]);
+
+            kernels::subtract(x.data() + o, y.data() + o, fast.data() + o, n);
+            kernels::reference::subtract(x.data() + o, y.data() + o, ref.data() + o, n);
+            check("subtract", n, fast.data() + o, ref.data() + o, worst[1]);
+
+            kernels::magnitude3(x.data() + o, y.data() + o, z.data() + o, fast.data() + o, n);
+            kernels::reference::magnitude3(x.data() + o, y.data() + o, z.data() + o, ref.data() + o, n);
+            check("magnitude3", n, fast.data() + o, ref.data() + o, worst[2]);
+
+            kernels::trapezoid(x.data() + o, dt.data() + o, S(0.5), S(1), fast.data() + o, n);
+            kernels::reference::trapezoid(x.data() + o, dt.data() + o, S(0.5), S(1), ref.data() + o, n);
+            check("trapezoid", n, fast.data() + o, ref.data() + o, worst[3]);
+        }
+    }
+
+    printf("kernels: %s, worst relative difference offset %.3g subtract %.3g magnitude3 %.3g trapezoid %.3g "
+           "(tolerance %.3g)\n",
+           kernels::implementation(), worst[0], worst[1], worst[2], worst[3], KERNEL_TOLERANCE);
+    if (failures > 0) {
+        fprintf(stderr, "%d outputs out of tolerance\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+// SampleClock against a simulated sensor: rows on a true schedule with a
+// crystal error, packed into packets that only carry the millisecond
+// (truncated) of their first row. Once the clock has settled, every
+// reconstructed row time must be within CLOCK_TOLERANCE_US of the true
+// one, across
+//  - a steady stream,
+//  - the 32-bit µs wrap,
+//  - a dropped packet,
+//  - a rate change, announced by the decoder or not,
+//  - a step in the sensor clock, which must relock the schedule once.
+// Exits non-zero if any case fails.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "SampleClock.hpp"
+
+namespace {
+
+// A quarter of the millisecond the packet timestamps resolve
+const double CLOCK_TOLERANCE_US = 250;
+// Settling after a (re)start: a few spans of the period fit
+const double SETTLE_MS = 4 * SAMPLE_CLOCK_FIT_MS;
+// The sensor crystal runs this much fast
+const double CRYSTAL_ERROR = 250e-6;
+
+struct Sensor {
+    double timeUs;      // true time of the next row, µs since an arbitrary origin
+    double periodUs;
+    int rows;
+    int sampleRate;     // the rate the decoder was told
+};
+
+struct Result {
+    double worstUs = 0;
+    uint32_t relocks = 0;
+};
+
+Sensor sensor(double startUs, int rate, int rows) {
+    Sensor s;
+    s.timeUs = startUs;
+    s.periodUs = 1e6 / (rate * (1 + CRYSTAL_ERROR));
+    s.rows = rows;
+    s.sampleRate = rate;
+    return s;
+}
+
+// Sends `packets` packets, checking rows from `checkFromUs` (true time) on
+bool run(SampleClock& clock, Sensor& s, int packets, double checkFromUs, Result& result, bool drop = false) {
+    uint32_t stamps[IMU6_MAX_ROWS];
+    for (int p = 0; p < packets; ++p) {
+        IMU6Packet packet;
+        packet.timestamp = static_cast<uint32_t>(static_cast<uint64_t>(s.timeUs / 1000));
+        packet.numRows = s.rows;
+        packet.sampleRate = s.sampleRate;
+        const double firstUs = s.timeUs;
+        s.timeUs += s.rows * s.periodUs;
+        if (drop && p == packets / 2) continue;
+
+        clock.stamp(packet, stamps);
+        for (int i = 0; i < s.rows; ++i) {
+            const double trueUs = firstUs + i * s.periodUs;
+            if (trueUs < checkFromUs) continue;
+            const uint32_t expected = static_cast<uint32_t>(static_cast<uint64_t>(trueUs));
+            const double error = std::fabs(static_cast<double>(static_cast<int32_t>(stamps[i] - expected)));
+            if (error > result.worstUs) result.worstUs = error;
+        }
+    }
+    result.relocks = clock.relocks();
+    return result.worstUs <= CLOCK_TOLERANCE_US;
+}
+
+int report(const char* name, bool ok, const Result& result, uint32_t expectedRelocks) {
+    const bool pass = ok && result.relocks == expectedRelocks;
+    printf("%-16s worst %6.1f us, relocks %u (expected %u)%s\n", name, result.worstUs, result.relocks,
+           expectedRelocks, pass ? "" : "  FAILED");
+    return pass ? 0 : 1;
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    const double startUs = 12345678.0;
+
+    {
+        SampleClock clock;
+        Sensor s = sensor(startUs, 833, 8);
+        Result r;
+        const bool ok = run(clock, s, 2000, startUs + SETTLE_MS * 1000, r);
+        failures += report("steady 833 Hz", ok, r, 0);
+    }
+    {
+        SampleClock clock;
+        Sensor s = sensor(startUs, 104, 8);
+        Result r;
+        const bool ok = run(clock, s, 200, startUs + SETTLE_MS * 1000, r);
+        failures += report("steady 104 Hz", ok, r, 0);
+    }
+    {
+        // Starts 3 s before the µs counter wraps and runs 10 s past it
+        SampleClock clock;
+        const double wrapUs = 4294967296.0;
+        Sensor s = sensor(wrapUs - 3e6, 833, 8);
+        Result r;
+        const bool ok = run(clock, s, 1350, wrapUs - 3e6 + SETTLE_MS * 1000, r);
+        failures += report("32-bit wrap", ok, r, 0);
+    }
+    {
+        // The schedule skips the lost rows by restarting at the next
+        // packet, and must stay in tolerance throughout
+        SampleClock clock;
+        Sensor s = sensor(startUs, 833, 8);
+        Result r;
+        bool ok = run(clock, s, 500, startUs + SETTLE_MS * 1000, r);
+        ok = run(clock, s, 500, 0, r, true) && ok;
+        failures += report("dropped packet", ok, r, 1);
+    }
+    {
+        // The decoder is told the new rate: the clock starts over from it
+        SampleClock clock;
+        Sensor s = sensor(startUs, 208, 8);
+        Result r;
+        bool ok = run(clock, s, 100, startUs + SETTLE_MS * 1000, r);
+        s = sensor(s.timeUs, 416, 8);
+        ok = run(clock, s, 200, s.timeUs + SETTLE_MS * 1000, r) && ok;
+        failures += report("rate change", ok, r, 1);
+    }
+    {
+        // The rate doubles behind the decoder's back: the period comes from
+        // the packet steps
+        SampleClock clock;
+        Sensor s = sensor(startUs, 208, 8);
+        Result r;
+        bool ok = run(clock, s, 100, startUs + SETTLE_MS * 1000, r);
+        const double changeUs = s.timeUs;
+        s.periodUs /= 2;
+        ok = run(clock, s, 200, changeUs + SETTLE_MS * 1000, r) && ok;
+        failures += report("unannounced rate", ok, r, 1);
+    }
+    {
+        // The sensor clock jumps 20 ms ahead, within SAMPLE_GAP_MS, so the
+        // stream goes on but the schedule has to restart at the packet
+        SampleClock clock;
+        Sensor s = sensor(startUs, 833, 8);
+        Result r;
+        bool ok = run(clock, s, 500, startUs + SETTLE_MS * 1000, r);
+        s.timeUs += 20000;
+        ok = run(clock, s, 500, s.timeUs + SETTLE_MS * 1000, r) && ok;
+        failures += report("clock step", ok, r, 1);
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+// TelemetryWriter on a link the sample stream overloads: 833 Hz samples
+// pumped at what a 115200 baud UART drains, with an impact frame every
+// half second and a stats frame every second in between. Sample frames
+// must be dropped, and every impact and stats frame must still reach the
+// decoder intact. Exits non-zero on failure.
+
+#include <cstdio>
+#include <vector>
+
+#include "MovesenseIMU6.hpp"
+#include "Telemetry.hpp"
+#include "TelemetryDecoder.hpp"
+#include "sim/MovesenseSim.hpp"
+
+namespace {
+
+// 8N1: ten bits on the wire per byte
+const double UART_BYTES_PER_SECOND = 115200.0 / 10.0;
+const int RATE = 833;
+const int ROWS = MOVESENSE_SIM_MAX_ROWS;
+const int SECONDS = 20;
+
+size_t capture(const uint8_t* data, size_t length, void* context) {
+    std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(context);
+    out->insert(out->end(), data, data + length);
+    return length;
+}
+
+} // namespace
+
+int main() {
+    const int packets = SECONDS * RATE / ROWS;
+    const double packetSeconds = double(ROWS) / RATE;
+    std::vector<float> acc(3 * ROWS, 0.1f), gyro(3 * ROWS, 1.0f);
+
+    TelemetryWriter writer;
+    std::vector<uint8_t> stream;
+    double uartCredit = 0;
+    uint32_t impactsWritten = 0, statsWritten = 0;
+
+    for (int p = 0; p < packets; ++p) {
+        const uint32_t nowUs = static_cast<uint32_t>(p * packetSeconds * 1e6);
+        const std::vector<uint8_t> raw = MovesenseSim::encodeIMU6(99, nowUs / 1000, acc.data(), gyro.data(), ROWS);
+        IMU6Packet packet;
+        decodeIMU6Packet(raw.data(), raw.size(), packet, RATE);
+        writer.writeSamples(packet, nowUs);
+
+        if (p % (RATE / ROWS / 2) == 0) {
+            ImpactReport report;
+            report.triggerTime = nowUs;
+            report.level = 2;
+            writer.writeImpact(report, nowUs);
+            impactsWritten++;
+        }
+        if (p % (RATE / ROWS) == 0) {
+            TelemetryStats stats;
+            stats.uptimeMs = nowUs / 1000;
+            stats.framesDropped = writer.framesDropped();
+            writer.writeStats(stats);
+            statsWritten++;
+        }
+
+        uartCredit += UART_BYTES_PER_SECOND * packetSeconds;
+        const size_t room = static_cast<size_t>(uartCredit);
+        uartCredit -= writer.pump(room, capture, &stream);
+        if (uartCredit > TELEMETRY_TX_BUFFER_SIZE) uartCredit = TELEMETRY_TX_BUFFER_SIZE;
+    }
+    writer.pump(TELEMETRY_TX_BUFFER_SIZE, capture, &stream);
+
+    telemetry::Decoder decoder;
+    uint32_t samples = 0, impacts = 0, stats = 0;
+    decoder.onSamples = [&](const telemetry::SamplesRecord&) { samples++; };
+    decoder.onImpact = [&](const telemetry::ImpactRecord&) { impacts++; };
+    decoder.onStats = [&](const telemetry::StatsRecord&) { stats++; };
+    decoder.feed(stream.data(), stream.size());
+
+    printf("telemetry: %d sample frames, %u delivered; impacts %u of %u, stats %u of %u\n", packets, samples,
+           impacts, impactsWritten, stats, statsWritten);
+    if (decoder.counters().invalidFrames != 0 || writer.recordsDropped() != 0 || impacts != impactsWritten ||
+        stats != statsWritten) {
+        fprintf(stderr, "impact or stats frames lost (%u dropped by the writer, %llu invalid)\n",
+                writer.recordsDropped(), static_cast<unsigned long long>(decoder.counters().invalidFrames));
+        return 1;
+    }
+    if (samples == static_cast<uint32_t>(packets)) {
+        fprintf(stderr, "the sample stream did not overload the link\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+// Turns latency trace dumps (the trace dump command) into per-impact
+// latency breakdowns and percentiles.
+//
+// Usage: latency_report [file]      reads stdin when no file is given
+//
+// Anything outside the TRACE BEGIN / TRACE END lines is ignored, so a raw
+// serial capture with telemetry around the dumps can be passed as is.
+// Entries repeated by later dumps of the same ring are counted once.
+//
+// Each impact (sensor and trigger time) gets one line with the time spent
+// between consecutive stages, in µs:
+//
+//   radio     sample taken -> notification (needs the clock alignment)
+//   decode    notification -> rows queued
+//   queue     rows queued -> trigger seen by loop()
+//   record    trigger -> post-trigger record complete
+//   led       metric job start -> LEDs written (level stage)
+//   metrics   metric job start -> finish (HIC and velocities included)
+//
+// followed by sample -> LED and notification -> LED totals. A "-" marks a
+// stage the trace does not have, e.g. a packet that had already left
+// PacketArrivals. The percentile table covers the impacts that have both
+// ends of a segment.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "LatencyTrace.hpp"
+
+namespace {
+
+const char* const BEGIN_MARKER = "TRACE BEGIN";
+const size_t STAGES = static_cast<size_t>(TraceStage::COUNT);
+
+struct Impact {
+    unsigned sensor = 0;
+    uint32_t triggerUs = 0;
+    bool has[STAGES] = {};
+    uint32_t at[STAGES] = {};
+};
+
+struct Segment {
+    const char* name;
+    TraceStage from;
+    TraceStage to;
+};
+
+const Segment SEGMENTS[] = {
+    {"radio", TraceStage::SAMPLE, TraceStage::ARRIVAL},
+    {"decode", TraceStage::ARRIVAL, TraceStage::INGEST},
+    {"queue", TraceStage::INGEST, TraceStage::DETECT},
+    {"record", TraceStage::DETECT, TraceStage::CAPTURE},
+    {"led", TraceStage::CAPTURE, TraceStage::LED},
+    {"metrics", TraceStage::CAPTURE, TraceStage::METRICS},
+    {"sample->led", TraceStage::SAMPLE, TraceStage::LED},
+    {"arrival->led", TraceStage::ARRIVAL, TraceStage::LED},
+};
+const size_t SEGMENT_COUNT = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+
+bool parseStage(const char* name, TraceStage& stage) {
+    for (size_t i = 0; i < STAGES; ++i) {
+        if (strcmp(name, LatencyTrace::stageName(static_cast<TraceStage>(i))) == 0) {
+            stage = static_cast<TraceStage>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool span(const Impact& impact, const Segment& segment, int32_t& us) {
+    const size_t from = static_cast<size_t>(segment.from);
+    const size_t to = static_cast<size_t>(segment.to);
+    if (!impact.has[from] || !impact.has[to]) return false;
+    // Receiver times wrap like micros()
+    us = static_cast<int32_t>(impact.at[to] - impact.at[from]);
+    return true;
+}
+
+// Nearest-rank percentile of sorted values
+int32_t percentile(const std::vector<int32_t>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    rank = std::max<size_t>(1, std::min(rank, sorted.size()));
+    return sorted[rank - 1];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    std::vector<Impact> impacts;
+    std::map<std::pair<unsigned, uint32_t>, size_t> byTrigger;
+    std::set<std::tuple<unsigned, int, uint32_t, uint32_t>> seen;
+    size_t dumps = 0, entries = 0, malformed = 0;
+    bool inDump = false;
+
+    std::string line;
+    for (int c; (c = fgetc(in)) != EOF || !line.empty();) {
+        if (c != '\n' && c != EOF) {
+            if (c != '\r') line += static_cast<char>(c);
+            continue;
+        }
+        // Telemetry bytes can run straight into the marker
+        const size_t marker = line.size() >= strlen(BEGIN_MARKER) ? line.size() - strlen(BEGIN_MARKER) : 0;
+        if (line.compare(marker, std::string::npos, BEGIN_MARKER) == 0) {
+            inDump = true;
+            dumps++;
+        } else if (inDump && line.compare(0, 9, "TRACE END") == 0) {
+            inDump = false;
+        } else if (inDump) {
+            unsigned sensor;
+            char name[16];
+            uint32_t sensorUs, receiverUs;
+            TraceStage stage;
+            if (sscanf(line.c_str(), "%u,%15[^,],%" SCNu32 ",%" SCNu32, &sensor, name, &sensorUs, &receiverUs) != 4 ||
+                !parseStage(name, stage)) {
+                malformed++;
+            } else if (seen.insert(std::make_tuple(sensor, static_cast<int>(stage), sensorUs, receiverUs)).second) {
+                entries++;
+                auto key = std::make_pair(sensor, sensorUs);
+                auto found = byTrigger.find(key);
+                if (found == byTrigger.end()) {
+                    found = byTrigger.emplace(key, impacts.size()).first;
+                    impacts.push_back(Impact());
+                    impacts.back().sensor = sensor;
+                    impacts.back().triggerUs = sensorUs;
+                }
+                Impact& impact = impacts[found->second];
+                impact.has[static_cast<size_t>(stage)] = true;
+                impact.at[static_cast<size_t>(stage)] = receiverUs;
+            }
+        }
+        line.clear();
+        if (c == EOF) break;
+    }
+    if (in != stdin) fclose(in);
+
+    printf("sensor,trigger_us");
+    for (const Segment& segment : SEGMENTS) printf(",%s", segment.name);
+    printf("\n");
+
+    std::vector<int32_t> values[SEGMENT_COUNT];
+    for (const Impact& impact : impacts) {
+        printf("%u,%" PRIu32, impact.sensor, impact.triggerUs);
+        for (size_t s = 0; s < SEGMENT_COUNT; ++s) {
+            int32_t us;
+            if (span(impact, SEGMENTS[s], us)) {
+                printf(",%" PRId32, us);
+                values[s].push_back(us);
+            } else {
+                printf(",-");
+            }
+        }
+        printf("\n");
+    }
+
+    printf("\n%-13s %6s %9s %9s %9s %9s %9s\n", "segment_us", "n", "min", "p50", "p90", "p99", "max");
+    for (size_t s = 0; s < SEGMENT_COUNT; ++s) {
+        std::vector<int32_t>& v = values[s];
+        if (v.empty()) {
+            printf("%-13s %6d\n", SEGMENTS[s].name, 0);
+            continue;
+        }
+        std::sort(v.begin(), v.end());
+        printf("%-13s %6zu %9" PRId32 " %9" PRId32 " %9" PRId32 " %9" PRId32 " %9" PRId32 "\n", SEGMENTS[s].name,
+               v.size(), v.front(), percentile(v, 50), percentile(v, 90), percentile(v, 99), v.back());
+    }
+
+    fprintf(stderr, "%zu dumps, %zu entries, %zu impacts, %zu malformed lines\n", dumps, entries, impacts.size(),
+            malformed);
+    return 0;
+}
@@ -1,7 +1,12 @@
 #include "BLEManager.hpp"
+#include "Profiler.hpp"
 
 // #define BLE_DEBUG
 
+SensorHub BLEManager::hub;
+BLEManager::Connection BLEManager::connections[SENSOR_MAX_DEVICES];
+TelemetryWriter* BLEManager::sampleStream = nullptr;
+
 /**
  * @brief Initialize the BLE module
  * 
@@ -10,6 +15,7 @@
  */
 bool BLEManager::begin() {
   bool success = BLE.begin();
+  BLE.setEventHandler(BLEDisconnected, disconnectedCallback);
 #ifdef BLE_DEBUG
   if (success) {
     Serial.println("BLE initialized");
@@ -23,69 +29,180 @@ bool BLEManager::begin() {
 /**
  * @brief Process BLE events
  * 
- * This method should be called regularly in the main loop
+ * This method should be called regularly in the main loop. It also
+ * advances a scan started with startScan() and reconnects dropped links.
  */
 void BLEManager::poll() {
   BLE.poll();
+  if (scanState == SCAN_RUNNING) {
+    pollScan();
+  }
+  superviseLinks();
 }
 
 /**
- * @brief Check if a device is already in the scanned devices list
+ * @brief Parse a "xx:xx:xx:xx:xx:xx" BLE address into its 48-bit value
  * 
- * @param device The BLE device to check
- * @return true if the device is already in the list
- * @return false if the device is not in the list
+ * @param text The address, hex digits in either case
+ * @return uint64_t The address, or 0 if the text is not an address
  */
-bool BLEManager::deviceAlreadyListed(BLEDevice device) {
+uint64_t BLEManager::parseAddress(const char* text) {
+  uint64_t address = 0;
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 2; j++) {
+      char c = *text++;
+      int digit;
+      if (c >= '0' && c <= '9') digit = c - '0';
+      else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+      else return 0;
+      address = (address << 4) | digit;
+    }
+    if (*text != (i < 5 ? ':' : '\0')) {
+      return 0;
+    }
+    text++;
+  }
+  return address;
+}
+
+/**
+ * @brief Find a device in the scannedDevices array by its address
+ * 
+ * @param address The 48-bit address to look up
+ * @return int The index of the device, or -1 if not found
+ */
+int BLEManager::findScanned(uint64_t address) const {
   for (int i = 0; i < deviceCount; i++) {
-    if (scannedDevices[i].address() == device.address()) {
-      return true;
+    if (scannedAddresses[i] == address) {
+      return i;
     }
   }
-  return false;
+  return -1;
 }
 
 /**
- * @brief Scan for available BLE devices
+ * @brief Start scanning for BLE devices
  * 
- * Scans for BLE devices for the duration specified by SCAN_TIME
- * and adds them to the scannedDevices array if they meet the
- * signal strength requirements (MIN_RSSI)
+ * Clears the device list and returns at once; poll() collects the
+ * advertisements. Devices that meet the signal strength requirement
+ * (MIN_RSSI) are added to the scannedDevices array. The scan stops after
+ * durationMs, or as soon as every target address has been seen, so a
+ * known sensor can be connected without waiting out the full scan.
+ * 
+ * @param targets Addresses to wait for, or nullptr to scan for the full duration
+ * @param count Number of addresses in targets, at most SENSOR_MAX_DEVICES
+ * @param durationMs Upper bound on the scan time
+ * @return true if the scan was started
+ * @return false if the BLE stack refused to scan
  */
-void BLEManager::scanDevices() {
+bool BLEManager::startScan(const char* const* targets, int count, unsigned long durationMs) {
   deviceCount = 0;
+  targetCount = 0;
+  for (int i = 0; i < count && targetCount < SENSOR_MAX_DEVICES; i++) {
+    uint64_t address = parseAddress(targets[i]);
+    if (address != 0) {
+      this->targets[targetCount] = address;
+      targetSeen[targetCount] = false;
+      targetCount++;
+    }
+  }
+
 #ifdef BLE_DEBUG
   Serial.println("Scanning for BLE devices...");
 #endif
-  BLE.scan();
-  unsigned long startTime = millis();
-  while (millis() - startTime < SCAN_TIME) {
-    BLEDevice dev = BLE.available();
-    if (dev) {
-      if (!deviceAlreadyListed(dev) && deviceCount < MAX_DEVICES && dev.rssi() >= MIN_RSSI) {
-        scannedDevices[deviceCount++] = dev;
-      }
-    }
+  if (!BLE.scan()) {
+    scanState = SCAN_IDLE;
+    return false;
+  }
+  scanState = SCAN_RUNNING;
+  scanStart = millis();
+  scanDuration = durationMs;
+  return true;
+}
+
+/**
+ * @brief Stop a running scan, keeping the devices found so far
+ */
+void BLEManager::stopScan() {
+  if (scanState != SCAN_RUNNING) {
+    return;
   }
   BLE.stopScan();
+  scanState = SCAN_IDLE;
 #ifdef BLE_DEBUG
   Serial.println("Scan complete.\n");
 #endif
 }
 
+/**
+ * @brief Collect pending advertisements of a running scan
+ * 
+ * Handles at most SCAN_REPORTS_PER_POLL advertisements per call, so a busy
+ * radio environment cannot hold up the main loop.
+ */
+void BLEManager::pollScan() {
+  for (int n = 0; n < SCAN_REPORTS_PER_POLL; n++) {
+    BLEDevice dev = BLE.available();
+    if (!dev) {
+      break;
+    }
+    uint64_t address = parseAddress(dev.address().c_str());
+    if (deviceCount < MAX_DEVICES && dev.rssi() >= MIN_RSSI && findScanned(address) == -1) {
+      scannedAddresses[deviceCount] = address;
+      scannedDevices[deviceCount++] = dev;
+      for (int i = 0; i < targetCount; i++) {
+        if (targets[i] == address) {
+          targetSeen[i] = true;
+        }
+      }
+    }
+  }
+
+  // Every wanted sensor is in the list: no need to wait out the scan
+  if (targetCount > 0) {
+    int seen = 0;
+    for (int i = 0; i < targetCount; i++) {
+      seen += targetSeen[i];
+    }
+    if (seen == targetCount) {
+      stopScan();
+      return;
+    }
+  }
+
+  if (millis() - scanStart >= scanDuration) {
+    stopScan();
+  }
+}
+
+/**
+ * @brief Scan for available BLE devices
+ * 
+ * Blocking form of startScan(): polls until the scan ends, after SCAN_TIME
+ * or once all targets have been seen.
+ * 
+ * @param targets Addresses to wait for, or nullptr to scan for SCAN_TIME
+ * @param count Number of addresses in targets
+ */
+void BLEManager::scanDevices(const char* const* targets, int count) {
+  if (!startScan(targets, count)) {
+    return;
+  }
+  while (scanning()) {
+    poll();
+  }
+}
+
 /**
  * @brief Get the index of a device in the scannedDevices array by address
  * 
  * @param address The BLE address to search for
  * @return int The index of the device, or -1 if not found
  */
-int BLEManager::getDeviceIndex(String address) {
-  for (int i = 0; i < deviceCount; i++) {
-    if (scannedDevices[i].address() == address) {
-      return i;
-    }
-  }
-  return -1;
+int BLEManager::getDeviceIndex(const char* address) const {
+  uint64_t key = parseAddress(address);
+  return key != 0 ? findScanned(key) : -1;
 }
 
 /**
@@ -132,33 +249,117 @@ bool BLEManager::selectDevice(int index) {
 #endif
     return false;
   }
+
+  // Already connected: just make it the target of later commands
+  Connection* connection = findConnection(scannedDevices[index]);
+  if (connection) {
+    selected = connection;
+    selectedDevice = connection->device;
+    return true;
+  }
+
+  connection = findConnection(BLEDevice());
+  if (!connection) {
+#ifdef BLE_DEBUG
+    Serial.println("All sensor slots are in use.");
+#endif
+    return false;
+  }
+
 #ifdef BLE_DEBUG
   Serial.print("Connecting to device ");
   Serial.println(scannedDevices[index].address());
 #endif
-  selectedDevice = scannedDevices[index];
-  if (selectedDevice.connect()) {
+  BLEDevice device = scannedDevices[index];
+  if (device.connect()) {
 #ifdef BLE_DEBUG
     Serial.println("Connected successfully!");
 #endif
+    *connection = Connection();
+    connection->device = device;
+    connection->pipeline = hub.attach();
+    selected = connection;
+    selectedDevice = device;
     return true;
   } else {
 #ifdef BLE_DEBUG
     Serial.println("Failed to connect.");
 #endif
-    selectedDevice = BLEDevice(); // Clear selection
     return false;
   }
 }
 
 /**
- * @brief Discover and list all services and characteristics of the connected device
+ * @brief Discover the attributes of a connection, once
+ * 
+ * The first call runs GATT discovery and resolves the Movesense GSP
+ * characteristics by UUID. Later calls return at once, so repeated
+ * commands cost no further discovery round-trips.
+ * 
+ * @param connection The connection to discover
+ * @return true if the attributes are known
+ * @return false if discovery failed
+ */
+bool BLEManager::discover(Connection& connection) {
+  if (connection.discovered) {
+    return true;
+  }
+  if (!connection.device.discoverAttributes()) {
+#ifdef BLE_DEBUG
+    Serial.println("Service discovery failed.");
+#endif
+    return false;
+  }
+  BLEService gsp = connection.device.service(MOVESENSE_GSP_SERVICE_UUID);
+  connection.command = gsp.characteristic(MOVESENSE_GSP_WRITE_UUID);
+  connection.data = gsp.characteristic(MOVESENSE_GSP_NOTIFY_UUID);
+  connection.discovered = true;
+  return true;
+}
+
+/**
+ * @brief Look up a characteristic of the selected device by index
+ * 
+ * @param sIndex The index of the service
+ * @param cIndex The index of the characteristic
+ * @return BLECharacteristic The characteristic, empty if there is none
+ */
+BLECharacteristic BLEManager::characteristicAt(int sIndex, int cIndex) {
+  if (!selected) {
+#ifdef BLE_DEBUG
+    Serial.println("No device connected.");
+#endif
+    return BLECharacteristic();
+  }
+  if (!discover(*selected)) {
+    return BLECharacteristic();
+  }
+  int svcCount = selectedDevice.serviceCount();
+  if (sIndex < 0 || sIndex >= svcCount) {
+#ifdef BLE_DEBUG
+    Serial.println("Invalid service index.");
+#endif
+    return BLECharacteristic();
+  }
+  BLEService service = selectedDevice.service(sIndex);
+  int charCount = service.characteristicCount();
+  if (cIndex < 0 || cIndex >= charCount) {
+#ifdef BLE_DEBUG
+    Serial.println("Invalid characteristic index.");
+#endif
+    return BLECharacteristic();
+  }
+  return service.characteristic(cIndex);
+}
+
+/**
+ * @brief List all services and characteristics of the connected device
  * 
  * Lists all services and characteristics to the Serial console, showing UUIDs
  * and properties (read, write, notify)
  */
 void BLEManager::listServicesAndCharacteristics() {
-  if (!selectedDevice) {
+  if (!selected) {
 #ifdef BLE_DEBUG
     Serial.println("No device connected.");
 #endif
@@ -167,10 +368,7 @@ void BLEManager::listServicesAndCharacteristics() {
 #ifdef BLE_DEBUG
   Serial.println("Discovering services...");
 #endif
-  if (!selectedDevice.discoverAttributes()) {
-#ifdef BLE_DEBUG
-    Serial.println("Failed to discover attributes.");
-#endif
+  if (!discover(*selected)) {
     return;
   }
   
@@ -220,106 +418,238 @@ void BLEManager::listServicesAndCharacteristics() {
  * @return false if subscription failed
  */
 bool BLEManager::subscribeCharacteristic(int sIndex, int cIndex) {
-  if (!selectedDevice) {
-#ifdef BLE_DEBUG
-    Serial.println("No device connected.");
-#endif
-    return false;
-  }
-  if (!selectedDevice.discoverAttributes()) {
-#ifdef BLE_DEBUG
-      Serial.println("Service discovery failed.");
-#endif
-    return false;
-  }
-  int svcCount = selectedDevice.serviceCount();
-  if (sIndex < 0 || sIndex >= svcCount) {
-#ifdef BLE_DEBUG
-    Serial.println("Invalid service index.");
-#endif
-    return false;
-  }
-  BLEService service = selectedDevice.service(sIndex);
-  int charCount = service.characteristicCount();
-  if (cIndex < 0 || cIndex >= charCount) {
-#ifdef BLE_DEBUG
-    Serial.println("Invalid characteristic index.");
-#endif
+  return subscribe(selected, characteristicAt(sIndex, cIndex));
+}
+
+/**
+ * @brief Unsubscribe from notifications from a characteristic
+ * 
+ * @param sIndex The index of the service
+ * @param cIndex The index of the characteristic
+ * @return true if unsubscription was successful
+ * @return false if unsubscription failed
+ */
+bool BLEManager::unsubscribeCharacteristic(int sIndex, int cIndex) {
+  return unsubscribe(selected, characteristicAt(sIndex, cIndex));
+}
+
+/**
+ * @brief Read the value of a characteristic
+ * 
+ * @param sIndex The index of the service
+ * @param cIndex The index of the characteristic
+ * @return true if read was successful
+ * @return false if read failed
+ */
+bool BLEManager::readCharacteristic(int sIndex, int cIndex) {
+  BLECharacteristic characteristic = characteristicAt(sIndex, cIndex);
+  if (!characteristic) {
     return false;
   }
-  selectedCharacteristic = service.characteristic(cIndex);
-  if (selectedCharacteristic.canSubscribe()) {
-    if (selectedCharacteristic.subscribe()) {
-      selectedCharacteristic.setEventHandler(BLEUpdated, notificationCallback);
+  if (characteristic.canRead()) {
+    if (characteristic.read()) {
 #ifdef BLE_DEBUG
-      Serial.print("Subscribed to characteristic ");
-      Serial.println(selectedCharacteristic.uuid());
+      Serial.print("Read from ");
+      Serial.print(characteristic.uuid());
+      Serial.print(": ");
+      int len = characteristic.valueLength();
+      const uint8_t* data = characteristic.value();
+      for (int i = 0; i < len; i++) {
+        Serial.print(data[i], HEX);
+        Serial.print(" ");
+      }
+      Serial.println();
 #endif
-      subscribed = true;
       return true;
     } else {
 #ifdef BLE_DEBUG
-      Serial.println("Subscription failed.");
+      Serial.println("Read failed.");
 #endif
       return false;
     }
   } else {
 #ifdef BLE_DEBUG
-    Serial.println("Characteristic does not support notifications.");
+    Serial.println("Characteristic is not readable.");
 #endif
     return false;
   }
 }
 
 /**
- * @brief Unsubscribe from notifications from a characteristic
+ * @brief Write a value to a characteristic
  * 
  * @param sIndex The index of the service
  * @param cIndex The index of the characteristic
- * @return true if unsubscription was successful
- * @return false if unsubscription failed
+ * @param data Pointer to the data to write
+ * @param length Length of the data to write
+ * @return true if write was successful
+ * @return false if write failed
  */
-bool BLEManager::unsubscribeCharacteristic(int sIndex, int cIndex) {
-  if (!selectedDevice) {
-#ifdef BLE_DEBUG
-    Serial.println("No device connected.");
-#endif
+bool BLEManager::writeCharacteristic(int sIndex, int cIndex, const uint8_t *data, int length) {
+  return write(characteristicAt(sIndex, cIndex), data, length);
+}
+
+/**
+ * @brief Write a GSP command to the selected Movesense sensor
+ * 
+ * Uses the write characteristic cached at discovery.
+ * 
+ * @param data Pointer to the command
+ * @param length Length of the command
+ * @return true if write was successful
+ * @return false if write failed
+ */
+bool BLEManager::writeSensorCommand(const uint8_t* data, int length) {
+  if (!selected || !discover(*selected)) {
     return false;
   }
-  if (!selectedDevice.discoverAttributes()) {
-#ifdef BLE_DEBUG
-    Serial.println("Service discovery failed.");
-#endif
+  return write(selected->command, data, length);
+}
+
+/**
+ * @brief Subscribe to the GSP data notifications of the selected sensor
+ */
+bool BLEManager::subscribeSensorData() {
+  if (!selected || !discover(*selected)) {
     return false;
   }
-  int svcCount = selectedDevice.serviceCount();
-  if (sIndex < 0 || sIndex >= svcCount) {
-#ifdef BLE_DEBUG
-    Serial.println("Invalid service index.");
-#endif
+  return subscribe(selected, selected->data);
+}
+
+/**
+ * @brief Unsubscribe from the GSP data notifications of the selected sensor
+ */
+bool BLEManager::unsubscribeSensorData() {
+  if (!selected || !discover(*selected)) {
     return false;
   }
-  BLEService service = selectedDevice.service(sIndex);
-  int charCount = service.characteristicCount();
-  if (cIndex < 0 || cIndex >= charCount) {
+  selected->streamCommandLength = 0;
+  return unsubscribe(selected, selected->data);
+}
+
+/**
+ * @brief Start a measurement stream on the selected sensor
+ * 
+ * Writes the GSP subscribe command and subscribes to the data
+ * notifications. The command is kept with the connection, so the stream
+ * can be resumed after a link drop.
+ * 
+ * @param command The GSP subscribe command, e.g. for /Meas/IMU6/104
+ * @param length Length of the command, at most SENSOR_COMMAND_MAX
+ * @param sampleRate Rate the command subscribes at in Hz, 0 if unknown
+ * @return true if the stream was started
+ * @return false if the write or subscription failed
+ */
+bool BLEManager::startSensorStream(const uint8_t* command, int length, int sampleRate) {
+  if (length < 2 || length > SENSOR_COMMAND_MAX) {
+    return false;
+  }
+  if (!writeSensorCommand(command, length) || !subscribeSensorData()) {
+    return false;
+  }
+  memcpy(selected->streamCommand, command, length);
+  selected->streamCommandLength = length;
+  selected->reference = command[1];
+  selected->sampleRate = sampleRate;
+  return true;
+}
+
+/**
+ * @brief Stop the measurement stream of the selected sensor
+ * 
+ * Unsubscribes the sensor from the reference the stream currently runs
+ * under, which changes with the rate, and from the data notifications.
+ * 
+ * @return true if the stream was stopped
+ * @return false if no stream was running or the unsubscription failed
+ */
+bool BLEManager::stopSensorStream() {
+  if (!selected || selected->streamCommandLength == 0) {
+    return false;
+  }
+  const uint8_t unsubscribeCommand[] = {GSP_COMMAND_UNSUBSCRIBE, selected->reference};
+  if (!writeSensorCommand(unsubscribeCommand, sizeof(unsubscribeCommand))) {
+    return false;
+  }
+  return unsubscribeSensorData();
+}
+
+/**
+ * @brief Switch a sensor's IMU6 stream to another rate
+ * 
+ * Subscribes at the new rate under the other of two references before the
+ * old subscription is dropped, so the sensor never stops sampling. From
+ * the switch on only packets of the new reference are processed; the few
+ * rows both streams cover are skipped by SensorHub::ingest(). The new
+ * command replaces the one replayed after a link drop.
+ * 
+ * @param slot Connection slot of the sensor
+ * @param sampleRate New rate in Hz, one the sensor supports
+ * @return true if the stream runs at sampleRate
+ * @return false if the sensor is not streaming or the subscribe failed
+ */
+bool BLEManager::setStreamRate(int slot, int sampleRate) {
+  if (slot < 0 || slot >= SENSOR_MAX_DEVICES) {
+    return false;
+  }
+  Connection& connection = connections[slot];
+  if (!connection.subscribed || connection.streamCommandLength == 0) {
+    return false;
+  }
+  if (connection.sampleRate == sampleRate) {
+    return true;
+  }
+
+  const uint8_t previous = connection.reference;
+  const uint8_t reference = previous == STREAM_REFERENCE ? STREAM_REFERENCE + 1 : STREAM_REFERENCE;
+  uint8_t command[IMU6_COMMAND_MAX];
+  const int length = imu6SubscribeCommand(command, reference, sampleRate);
+  if (!write(connection.command, command, length)) {
+    return false;
+  }
+  memcpy(connection.streamCommand, command, length);
+  connection.streamCommandLength = length;
+  connection.reference = reference;
+  connection.sampleRate = sampleRate;
+  connection.rateChanges++;
+
+  // Should this fail, the old stream's packets keep being ignored
+  const uint8_t unsubscribeCommand[] = {GSP_COMMAND_UNSUBSCRIBE, previous};
+  write(connection.command, unsubscribeCommand, sizeof(unsubscribeCommand));
 #ifdef BLE_DEBUG
-    Serial.println("Invalid characteristic index.");
+  Serial.print("Stream rate ");
+  Serial.println(sampleRate);
+#endif
+  return true;
+}
+
+/**
+ * @brief Subscribe a connection to a characteristic's notifications
+ * 
+ * @param connection The connection the characteristic belongs to
+ * @param characteristic The characteristic, may be empty
+ * @return true if subscription was successful
+ * @return false if subscription failed
+ */
+bool BLEManager::subscribe(Connection* connection, BLECharacteristic characteristic) {
+  if (!characteristic) {
+#ifdef BLE_DEBUG
+    Serial.println("Characteristic not found.");
 #endif
     return false;
   }
-  BLECharacteristic characteristic = service.characteristic(cIndex);
   if (characteristic.canSubscribe()) {
-    if (characteristic.unsubscribe()) {
+    if (characteristic.subscribe()) {
+      characteristic.setEventHandler(BLEUpdated, notificationCallback);
 #ifdef BLE_DEBUG
-      Serial.print("Unsubscribed from characteristic ");
+      Serial.print("Subscribed to characteristic ");
       Serial.println(characteristic.uuid());
 #endif
-      subscribed = false;
-      IMUProcessor::getInstance().clearData();
+      connection->subscribed = true;
       return true;
     } else {
 #ifdef BLE_DEBUG
-      Serial.println("Unsubscribe failed.");
+      Serial.println("Subscription failed.");
 #endif
       return false;
     }
@@ -332,66 +662,42 @@ bool BLEManager::unsubscribeCharacteristic(int sIndex, int cIndex) {
 }
 
 /**
- * @brief Read the value of a characteristic
+ * @brief Unsubscribe a connection from a characteristic
  * 
- * @param sIndex The index of the service
- * @param cIndex The index of the characteristic
- * @return true if read was successful
- * @return false if read failed
+ * Also resets the connection's sensor pipeline.
+ * 
+ * @param connection The connection the characteristic belongs to
+ * @param characteristic The characteristic, may be empty
+ * @return true if unsubscription was successful
+ * @return false if unsubscription failed
  */
-bool BLEManager::readCharacteristic(int sIndex, int cIndex) {
-  if (!selectedDevice) {
+bool BLEManager::unsubscribe(Connection* connection, BLECharacteristic characteristic) {
+  if (!characteristic) {
 #ifdef BLE_DEBUG
-    Serial.println("No device connected.");
+    Serial.println("Characteristic not found.");
 #endif
     return false;
   }
-  if (!selectedDevice.discoverAttributes()) {
-#ifdef BLE_DEBUG
-    Serial.println("Service discovery failed.");
-#endif
-    return false;
-  }
-  int svcCount = selectedDevice.serviceCount();
-  if (sIndex < 0 || sIndex >= svcCount) {
-#ifdef BLE_DEBUG
-    Serial.println("Invalid service index.");
-#endif
-    return false;
-  }
-  BLEService service = selectedDevice.service(sIndex);
-  int charCount = service.characteristicCount();
-  if (cIndex < 0 || cIndex >= charCount) {
+  if (characteristic.canSubscribe()) {
+    if (characteristic.unsubscribe()) {
 #ifdef BLE_DEBUG
-    Serial.println("Invalid characteristic index.");
+      Serial.print("Unsubscribed from characteristic ");
+      Serial.println(characteristic.uuid());
 #endif
-    return false;
-  }
-  BLECharacteristic characteristic = service.characteristic(cIndex);
-  if (characteristic.canRead()) {
-    if (characteristic.read()) {
-#ifdef BLE_DEBUG
-      Serial.print("Read from ");
-      Serial.print(characteristic.uuid());
-      Serial.print(": ");
-      int len = characteristic.valueLength();
-      const uint8_t* data = characteristic.value();
-      for (int i = 0; i < len; i++) {
-        Serial.print(data[i], HEX);
-        Serial.print(" ");
+      connection->subscribed = false;
+      if (connection->pipeline) {
+        connection->pipeline->reset();
       }
-      Serial.println();
-#endif
       return true;
     } else {
 #ifdef BLE_DEBUG
-      Serial.println("Read failed.");
+      Serial.println("Unsubscribe failed.");
 #endif
       return false;
     }
   } else {
 #ifdef BLE_DEBUG
-    Serial.println("Characteristic is not readable.");
+    Serial.println("Characteristic does not support notifications.");
 #endif
     return false;
   }
@@ -400,42 +706,19 @@ bool BLEManager::readCharacteristic(int sIndex, int cIndex) {
 /**
  * @brief Write a value to a characteristic
  * 
- * @param sIndex The index of the service
- * @param cIndex The index of the characteristic
+ * @param characteristic The characteristic, may be empty
  * @param data Pointer to the data to write
  * @param length Length of the data to write
  * @return true if write was successful
  * @return false if write failed
  */
-bool BLEManager::writeCharacteristic(int sIndex, int cIndex, const uint8_t *data, int length) {
-  if (!selectedDevice) {
-#ifdef BLE_DEBUG
-    Serial.println("No device connected.");
-#endif
-    return false;
-  }
-  if (!selectedDevice.discoverAttributes()) {
+bool BLEManager::write(BLECharacteristic characteristic, const uint8_t* data, int length) {
+  if (!characteristic) {
 #ifdef BLE_DEBUG
-    Serial.println("Service discovery failed.");
+    Serial.println("Characteristic not found.");
 #endif
     return false;
   }
-  int svcCount = selectedDevice.serviceCount();
-  if (sIndex < 0 || sIndex >= svcCount) {
-#ifdef BLE_DEBUG
-    Serial.println("Invalid service index.");
-#endif
-    return false;
-  }
-  BLEService service = selectedDevice.service(sIndex);
-  int charCount = service.characteristicCount();
-  if (cIndex < 0 || cIndex >= charCount) {
-#ifdef BLE_DEBUG
-    Serial.println("Invalid characteristic index.");
-#endif
-    return false;
-  }
-  BLECharacteristic characteristic = service.characteristic(cIndex);
   if (characteristic.canWrite()) {
     if (characteristic.writeValue(data, length)) {
 #ifdef BLE_DEBUG
@@ -464,9 +747,10 @@ bool BLEManager::writeCharacteristic(int sIndex, int cIndex, const uint8_t *data
 }
 
 /**
- * @brief Disconnect from the currently connected device
+ * @brief Disconnect from the currently selected device
  * 
- * Closes the connection with the currently selected device
+ * Closes the connection with the currently selected device and frees its
+ * sensor pipeline. Other connected sensors keep streaming.
  */
 void BLEManager::disconnect() {
   if (selectedDevice) {
@@ -474,6 +758,9 @@ void BLEManager::disconnect() {
 #ifdef BLE_DEBUG
     Serial.println("Disconnected.");
 #endif
+    hub.detach(selected->pipeline);
+    *selected = Connection();
+    selected = nullptr;
     selectedDevice = BLEDevice();
 #ifdef BLE_DEBUG
   } else {
@@ -485,76 +772,177 @@ void BLEManager::disconnect() {
 /**
  * @brief Callback function for BLE characteristic notifications
  * 
- * This method is called when a subscribed characteristic is updated.
- * It processes the received IMU data and forwards it to the IMUProcessor.
+ * This method is called from BLE.poll() when a subscribed characteristic is
+ * updated. It only decodes the IMU data into the sample queue of the
+ * sending sensor's pipeline; processing happens when the main loop drains
+ * the queues, so BLE event handling is not held up by fusion and impact
+ * detection.
  * 
  * @param device The BLE device that sent the notification
  * @param characteristic The characteristic that was updated
  */
 void BLEManager::notificationCallback(BLEDevice device, BLECharacteristic characteristic) {
+  const uint32_t arrivalUs = micros();
+  PROFILE_SCOPE(DECODE);
+  Connection* connection = findConnection(device);
+  if (!connection || !connection->pipeline) {
+    return;
+  }
+
   int length = characteristic.valueLength();
   const uint8_t* data = characteristic.value();
 
-  if (length < 6) {
+  IMU6Packet packet;
+  IMU6Status status = decodeIMU6Packet(data, length, packet, connection->sampleRate);
+  if (status == IMU6Status::TOO_SHORT) {
 #ifdef BLE_DEBUG
     Serial.println("Data too short.");
 #endif
     return;
   }
-  if (length > 150) {
+  if (status == IMU6Status::TOO_LONG) {
 #ifdef BLE_DEBUG
     Serial.println("Data length exceeds maximum limit.");
 #endif
     return;
   }
+  if (status == IMU6Status::TRUNCATED) {
+#ifdef BLE_DEBUG
+    Serial.println("Data shorter than announced rows.");
+#endif
+    return;
+  }
+  if (connection->streamCommandLength > 0 && packet.reference != connection->reference) {
+    return;
+  }
 
-  DataView dv = DataView(data, length);
-
-  uint8_t packet_type = dv.getUint8(0);
-  uint16_t reference = dv.getUint8(1);
-  uint32_t timestamp = dv.getUint32(2);
-
-  const int sensorDataSize = 12;
-  const int numRows = (length - 2) / (2 * sensorDataSize); 
-  const int sampleRate = numRows * 13;
-  
-  IMUProcessor& processor = IMUProcessor::getInstance();
+  if (sampleStream) {
+    sampleStream->writeSamples(packet, arrivalUs, connection->pipeline->id);
+  }
 
-// #ifdef BLE_DEBUG
-//   Serial.print("IMU Data - Timestamp: ");
-//   Serial.print(timestamp);
-//   Serial.print(" Sample Rate: ");
-//   Serial.print(sampleRate);
-//   Serial.print(" Hz\n");
-// #endif
+  if (hub.ingest(*connection->pipeline, packet, arrivalUs) > 0) {
+    connection->pipeline->arrivals.queued(micros());
+  }
+}
 
-  for (int i = 0; i < numRows; ++i) {
-    uint32_t row_timestamp = timestamp + int(i * 1000 / sampleRate);
+/**
+ * @brief Whether any connected sensor is subscribed
+ */
+bool BLEManager::isSubscribed() const {
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    if (connections[i].subscribed) {
+      return true;
+    }
+  }
+  return false;
+}
 
-    float accX = dv.getFloat32(6 + i * sensorDataSize);
-    float accY = dv.getFloat32(6 + i * sensorDataSize + 4);
-    float accZ = dv.getFloat32(6 + i * sensorDataSize + 8);
+/**
+ * @brief Whether any connected sensor has lost its link and is being reconnected
+ */
+bool BLEManager::isReconnecting() const {
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    if (connections[i].linkLost) {
+      return true;
+    }
+  }
+  return false;
+}
 
-    float gyroX = dv.getFloat32(6 + numRows * sensorDataSize + i * sensorDataSize);
-    float gyroY = dv.getFloat32(6 + numRows * sensorDataSize + i * sensorDataSize + 4);
-    float gyroZ = dv.getFloat32(6 + numRows * sensorDataSize + i * sensorDataSize + 8);
+/**
+ * @brief Callback function for BLE disconnect events
+ * 
+ * A sensor that drops out (out of range, reset, ...) keeps its connection
+ * slot and pipeline; superviseLinks() reconnects it. A disconnect asked for
+ * with disconnect() has already freed the slot and is ignored.
+ * 
+ * @param device The BLE device that disconnected
+ */
+void BLEManager::disconnectedCallback(BLEDevice device) {
+  Connection* connection = findConnection(device);
+  if (!connection || !device) {
+    return;
+  }
+#ifdef BLE_DEBUG
+  Serial.print("Link lost: ");
+  Serial.println(device.address());
+#endif
+  connection->subscribed = false;
+  // The stack drops the remote attributes with the link
+  connection->discovered = false;
+  connection->command = BLECharacteristic();
+  connection->data = BLECharacteristic();
+  // A failed reconnect attempt keeps its backoff
+  if (!connection->linkLost) {
+    connection->linkLost = true;
+    connection->backoffMs = RECONNECT_BACKOFF_MIN_MS;
+    connection->retryAt = millis() + connection->backoffMs;
+  }
+}
 
+/**
+ * @brief Reconnect sensors whose link dropped
+ * 
+ * Retries each lost link after its backoff, doubling the backoff up to
+ * RECONNECT_BACKOFF_MAX_MS after every failed attempt. The sensor
+ * pipeline is left alone, so orientation, bias and sample buffer carry
+ * over; IMUProcessor sees the gap in the sample timestamps.
+ */
+void BLEManager::superviseLinks() {
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    Connection& connection = connections[i];
+    if (!connection.linkLost || static_cast<long>(millis() - connection.retryAt) < 0) {
+      continue;
+    }
+    if (resume(connection)) {
+      connection.linkLost = false;
+      connection.backoffMs = RECONNECT_BACKOFF_MIN_MS;
+      connection.reconnects++;
 #ifdef BLE_DEBUG
-    // Format for serial plotter
-    Serial.print("accX:");
-    Serial.print(accX);
-    Serial.print(" accY:");
-    Serial.print(accY);
-    Serial.print(" accZ:");
-    Serial.print(accZ);
-    Serial.print(" gyroX:");
-    Serial.print(gyroX);
-    Serial.print(" gyroY:");
-    Serial.print(gyroY);
-    Serial.print(" gyroZ:");
-    Serial.println(gyroZ);
+      Serial.print("Reconnected: ");
+      Serial.println(connection.device.address());
 #endif
+      continue;
+    }
+    connection.backoffMs = connection.backoffMs * 2 > RECONNECT_BACKOFF_MAX_MS ? RECONNECT_BACKOFF_MAX_MS : connection.backoffMs * 2;
+    connection.retryAt = millis() + connection.backoffMs;
+  }
+}
+
+/**
+ * @brief Reconnect one sensor and restart its stream
+ * 
+ * @param connection The connection whose link dropped
+ * @return true if the sensor is connected and streaming again
+ * @return false if any step failed; the link is closed again
+ */
+bool BLEManager::resume(Connection& connection) {
+  if (!connection.device.connected() && !connection.device.connect()) {
+    return false;
+  }
+  bool ok = discover(connection);
+  if (ok && connection.streamCommandLength > 0) {
+    ok = write(connection.command, connection.streamCommand, connection.streamCommandLength) &&
+         subscribe(&connection, connection.data);
+  }
+  if (!ok) {
+    // Start over from a clean link on the next attempt
+    connection.device.disconnect();
+  }
+  return ok;
+}
 
-    processor.processData(accX, accY, accZ, gyroX, gyroY, gyroZ, row_timestamp);
+/**
+ * @brief Find the connection slot of a device
+ * 
+ * @param device The device to look up; an empty BLEDevice finds a free slot
+ * @return Connection* The slot, or nullptr if there is none
+ */
+BLEManager::Connection* BLEManager::findConnection(const BLEDevice& device) {
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    if (connections[i].device == device) {
+      return &connections[i];
+    }
   }
+  return nullptr;
 }
@@ -5,65 +5,60 @@
 #include <cstdint>
 #include <cstring>
 #include "IMUProcessor.hpp"
+#include "MovesenseIMU6.hpp"
+#include "SampleQueue.hpp"
+#include "SensorHub.hpp"
+#include "Telemetry.hpp"
 
 #define MAX_DEVICES 10
 #define MIN_RSSI -80
 #define SCAN_TIME 5000
-
-class DataView {
-private:
-    const uint8_t* buffer_;
-    const size_t length_;
-
-public:
-    DataView(const uint8_t* buffer, size_t length)
-        : buffer_(buffer), length_(length) {}
-
-    bool checkBounds(size_t startIndex, size_t byteCount) const {
-        return (startIndex + byteCount) <= length_;
-    }
-
-    uint8_t getUint8(size_t startIndex) const {
-        if (!checkBounds(startIndex, 1)) return 0;
-        return buffer_[startIndex];
-    }
-
-    uint16_t getUint16(size_t startIndex) const {
-        if (!checkBounds(startIndex, 2)) return 0;
-        uint16_t value;
-        memcpy(&value, buffer_ + startIndex, sizeof(value));
-        return value;
-    }
-
-    uint32_t getUint32(size_t startIndex) const {
-        if (!checkBounds(startIndex, 4)) return 0;
-        uint32_t value;
-        memcpy(&value, buffer_ + startIndex, sizeof(value));
-        return value;
-    }
-
-    int32_t getInt32(size_t startIndex) const {
-        if (!checkBounds(startIndex, 4)) return 0;
-        int32_t value;
-        memcpy(&value, buffer_ + startIndex, sizeof(value));
-        return value;
-    }
-
-    float getFloat32(size_t startIndex) const {
-        if (!checkBounds(startIndex, 4)) return 0.0f;
-        float value;
-        memcpy(&value, buffer_ + startIndex, sizeof(value));
-        return value;
-    }
-};
+#define SCAN_REPORTS_PER_POLL 8
+// Reconnect attempts after a link drop back off from MIN to MAX
+#define RECONNECT_BACKOFF_MIN_MS 100
+#define RECONNECT_BACKOFF_MAX_MS 2000
+#define SENSOR_COMMAND_MAX 32
+// GSP reference of a stream; a rate change alternates with the next one
+#define STREAM_REFERENCE 99
 
 class BLEManager {
 public:
-  BLEManager(): deviceCount(0) {};
+  // One connected sensor and the pipeline its notifications are routed to
+  struct Connection {
+    BLEDevice device;
+    SensorPipeline* pipeline = nullptr;
+    bool subscribed = false;
+    // Attributes are discovered once per connection; the Movesense GSP
+    // characteristics are resolved by UUID and kept here
+    bool discovered = false;
+    BLECharacteristic command;
+    BLECharacteristic data;
+    // Link supervision: a dropped link is reconnected with backoff and the
+    // stream command replayed, keeping the pipeline state
+    bool linkLost = false;
+    unsigned long retryAt = 0;
+    unsigned long backoffMs = RECONNECT_BACKOFF_MIN_MS;
+    uint32_t reconnects = 0;
+    uint8_t streamCommand[SENSOR_COMMAND_MAX];
+    int streamCommandLength = 0;
+    // Subscription the data is taken from; packets of any other
+    // reference are left over from before a rate change
+    uint8_t reference = 0;
+    int sampleRate = 0;
+    uint32_t rateChanges = 0;
+  };
+
+  BLEManager(): deviceCount(0), targetCount(0), scanState(SCAN_IDLE), scanStart(0), scanDuration(0) {};
   
   bool begin();
   void poll();
-  void scanDevices();
+  // Start a scan that poll() advances. It ends after durationMs, or as soon
+  // as every address in targets has been seen.
+  bool startScan(const char* const* targets = nullptr, int count = 0, unsigned long durationMs = SCAN_TIME);
+  void stopScan();
+  bool scanning() const { return scanState == SCAN_RUNNING; }
+  // Blocking scan: startScan() and poll() until it ends
+  void scanDevices(const char* const* targets = nullptr, int count = 0);
   void listDevices();
   bool selectDevice(int index);
   void listServicesAndCharacteristics();
@@ -71,20 +66,74 @@ public:
   bool unsubscribeCharacteristic(int sIndex, int cIndex);
   bool readCharacteristic(int sIndex, int cIndex);
   bool writeCharacteristic(int sIndex, int cIndex, const uint8_t *data, int length);
+  // Movesense GSP commands and data on the selected sensor, through the
+  // characteristics cached at discovery
+  bool writeSensorCommand(const uint8_t* data, int length);
+  bool subscribeSensorData();
+  bool unsubscribeSensorData();
+  // Write a GSP subscribe command and subscribe to the data; the stream is
+  // restarted with the same command if the link drops. sampleRate is the
+  // rate the command subscribes at, 0 to derive it from the packets.
+  bool startSensorStream(const uint8_t* command, int length, int sampleRate = 0);
+  // Write the GSP unsubscribe for the current stream and stop the data
+  bool stopSensorStream();
+  // Move a streaming sensor's IMU6 subscription to another rate without
+  // a gap in its samples
+  bool setStreamRate(int slot, int sampleRate);
   void disconnect();
-  int getDeviceIndex(String address);
+  int getDeviceIndex(const char* address) const;
+
+  // True while any connected sensor is streaming
+  bool isSubscribed() const;
+  // True while a sensor's link is down and being reconnected
+  bool isReconnecting() const;
 
-  bool isSubscribed() const { return subscribed; }
+  // 48-bit value of a "xx:xx:xx:xx:xx:xx" address, 0 if the text is not one
+  static uint64_t parseAddress(const char* text);
+  // Pipeline of the selected sensor, nullptr if none is selected
+  SensorPipeline* selectedPipeline() const { return selected ? selected->pipeline : nullptr; }
+
+  // Per-sensor pipelines fed by the notification callback, drained by the main loop
+  static SensorHub& sensors() { return hub; }
+  // Connection slots, SENSOR_MAX_DEVICES of them; unused slots have no device
+  static const Connection& connection(int slot) { return connections[slot]; }
+
+  // Forward every received IMU6 packet as a telemetry samples record, nullptr to stop
+  static void setSampleStream(TelemetryWriter* stream) { sampleStream = stream; }
 
 private:
-  bool deviceAlreadyListed(BLEDevice device);
+  enum ScanState { SCAN_IDLE, SCAN_RUNNING };
+
+  void pollScan();
+  int findScanned(uint64_t address) const;
+  bool discover(Connection& connection);
+  BLECharacteristic characteristicAt(int sIndex, int cIndex);
+  bool subscribe(Connection* connection, BLECharacteristic characteristic);
+  bool unsubscribe(Connection* connection, BLECharacteristic characteristic);
+  bool write(BLECharacteristic characteristic, const uint8_t* data, int length);
   static void notificationCallback(BLEDevice device, BLECharacteristic characteristic);
+  static void disconnectedCallback(BLEDevice device);
+  void superviseLinks();
+  bool resume(Connection& connection);
+  static Connection* findConnection(const BLEDevice& device);
+
+  static SensorHub hub;
+  static Connection connections[SENSOR_MAX_DEVICES];
+  static TelemetryWriter* sampleStream;
 
-  bool subscribed = false;
+  // The connection that service/characteristic commands act on
+  Connection* selected = nullptr;
   BLEDevice selectedDevice;
-  BLECharacteristic selectedCharacteristic;
-  BLEDevice scannedDevices[10];
+  // Scan results, looked up by their 48-bit address rather than as Strings
+  BLEDevice scannedDevices[MAX_DEVICES];
+  uint64_t scannedAddresses[MAX_DEVICES];
   int deviceCount;
+  uint64_t targets[SENSOR_MAX_DEVICES];
+  bool targetSeen[SENSOR_MAX_DEVICES];
+  int targetCount;
+  ScanState scanState;
+  unsigned long scanStart;
+  unsigned long scanDuration;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "Calibration.hpp"
+
+#include <cmath>
+
+#include "ImpactMetrics.hpp"
+
+void BiasEstimator::reset() {
+    *this = BiasEstimator();
+}
+
+void BiasEstimator::set(const SensorCalibration& calibration) {
+    reset();
+    for (int k = 0; k < 3; ++k) {
+        estimate_.mean[k] = calibration.accBias[k];
+        estimate_.mean[3 + k] = calibration.gyroBias[k];
+    }
+    estimate_.count = calibration.samples < BIAS_TRACK_SAMPLES ? calibration.samples : BIAS_TRACK_SAMPLES;
+}
+
+void BiasEstimator::interrupt() {
+    still_ = false;
+    pending_.count = 0;
+}
+
+SensorCalibration BiasEstimator::calibration() const {
+    SensorCalibration calibration;
+    for (int k = 0; k < 3; ++k) {
+        calibration.accBias[k] = static_cast<float>(estimate_.mean[k]);
+        calibration.gyroBias[k] = static_cast<float>(estimate_.mean[3 + k]);
+    }
+    calibration.samples = estimate_.count;
+    return calibration;
+}
+
+void BiasEstimator::add(Running& running, const Scalar* sample, uint32_t cap) {
+    if (running.count < cap) {
+        running.count++;
+    }
+    const Scalar weight = S(1) / running.count;
+    for (int k = 0; k < 6; ++k) {
+        running.mean[k] += (sample[k] - running.mean[k]) * weight;
+    }
+}
+
+Scalar BiasEstimator::distance(const Scalar* a, const Scalar* b) {
+    const Scalar dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+bool BiasEstimator::update(const Scalar* acc, const Scalar* gyro, uint32_t timestamp) {
+    const Scalar zero[3] = {0, 0, 0};
+    const Scalar accNorm = distance(acc, zero);
+    bool still = std::fabs(accNorm - S(G_CONSTANT)) <= S(BIAS_STILL_ACC_TOLERANCE) &&
+                 distance(gyro, zero) <= S(BIAS_GYRO_LIMIT);
+    // Against the period's own mean, so a constant gyro offset reads as still
+    if (still && still_) {
+        still = distance(gyro, period_.mean + 3) <= S(BIAS_STILL_GYRO_MAX) &&
+                distance(acc, period_.mean) <= S(BIAS_STILL_ACC_MAX);
+    }
+    if (!still) {
+        still_ = false;
+        pending_.count = 0;
+        return false;
+    }
+    
+    // Reading minus 1 g along its own direction, and the gyro as is
+    const Scalar excess = S(1) - S(G_CONSTANT) / accNorm;
+    const Scalar sample[6] = {acc[0] * excess, acc[1] * excess, acc[2] * excess, gyro[0], gyro[1], gyro[2]};
+    
+    if (!still_) {
+        still_ = true;
+        stillSince_ = timestamp;
+        period_ = Running{0, {0, 0, 0, 0, 0, 0}};
+        pending_ = Running{0, {0, 0, 0, 0, 0, 0}};
+    }
+    const Scalar raw[6] = {acc[0], acc[1], acc[2], gyro[0], gyro[1], gyro[2]};
+    add(period_, raw, BIAS_TRACK_SAMPLES);
+    if (timestamp - stillSince_ < BIAS_STILL_MIN_MS * 1000u) {
+        add(pending_, sample, UINT32_MAX);
+        return false;
+    }
+    
+    // Still for long enough: fold in the samples held back so far (Chan's
+    // merge of two means), then every further sample as it comes
+    if (pending_.count > 0) {
+        const uint32_t merged = estimate_.count + pending_.count;
+        const Scalar weight = static_cast<Scalar>(pending_.count) / merged;
+        for (int k = 0; k < 6; ++k) {
+            estimate_.mean[k] += (pending_.mean[k] - estimate_.mean[k]) * weight;
+        }
+        estimate_.count = merged < BIAS_TRACK_SAMPLES ? merged : BIAS_TRACK_SAMPLES;
+        total_ += pending_.count;
+        pending_.count = 0;
+    }
+    add(estimate_, sample, BIAS_TRACK_SAMPLES);
+    total_++;
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <cstdint>
+#include "Scalar.hpp"
+
+// A sample is still when |acc| is this close to 1 g (m/s²) ...
+#define BIAS_STILL_ACC_TOLERANCE 0.5
+// ... and |gyro| is below this (rad/s, about 20°/s); larger readings are
+// rotation, well beyond any MEMS gyro's zero-rate offset ...
+#define BIAS_GYRO_LIMIT 0.35
+// ... and the gyro (rad/s) and acceleration (m/s²) vectors stay this close
+// to their mean over the still period so far
+#define BIAS_STILL_GYRO_MAX 0.05
+#define BIAS_STILL_ACC_MAX 0.3
+// Samples only refine the bias once the sensor has been still this long
+#define BIAS_STILL_MIN_MS 1000
+// The estimate weighs at most this many samples, so it follows slow drift
+// (e.g. the sensor warming up) instead of averaging over the whole ride
+#define BIAS_TRACK_SAMPLES 2000
+
+// Sensor biases, as stored in flash and applied by IMUProcessor
+struct SensorCalibration {
+    float accBias[3] = {0, 0, 0};   // m/s²
+    float gyroBias[3] = {0, 0, 0};  // rad/s
+    uint32_t samples = 0;           // still samples behind the estimate
+};
+
+// Running bias estimate from the periods in which the sensor lies still.
+//
+// Stillness is judged by how steady the readings are, not by the gyro
+// being near zero: a sensor whose gyro bias exceeds BIAS_STILL_GYRO_MAX
+// reads that bias at rest, and is exactly the one that needs calibrating.
+//
+// Still samples are averaged per channel with Welford's incremental mean,
+// which stays accurate in float over long runs. A still period only counts
+// once it has lasted BIAS_STILL_MIN_MS, so the samples of a brief pause in
+// motion are discarded. The sample count is capped at BIAS_TRACK_SAMPLES,
+// after which each new sample moves the estimate by 1/BIAS_TRACK_SAMPLES.
+//
+// At rest the accelerometer reads gravity plus bias. Only the part of the
+// bias along gravity can be told apart from a tilt, so each still sample
+// contributes its reading minus 1 g along the reading's own direction; no
+// orientation is assumed.
+class BiasEstimator {
+public:
+    void reset();
+    // Start from a stored calibration
+    void set(const SensorCalibration& calibration);
+    // End the current still period (the stream stopped); keeps the estimate
+    void interrupt();
+    
+    // Feed one raw sample (timestamp in µs); returns true when the estimate changed
+    bool update(const Scalar* acc, const Scalar* gyro, uint32_t timestamp);
+    
+    bool valid() const { return estimate_.count > 0; }
+    SensorCalibration calibration() const;
+    // Still samples used since reset(), including those beyond the cap
+    uint32_t totalSamples() const { return total_; }
+    
+private:
+    struct Running {
+        uint32_t count;
+        Scalar mean[6];   // acc bias xyz, gyro xyz
+    };
+    
+    static void add(Running& running, const Scalar* sample, uint32_t cap);
+    static Scalar distance(const Scalar* a, const Scalar* b);
+    
+    Running estimate_ = {0, {0, 0, 0, 0, 0, 0}};
+    // Raw readings (acc xyz, gyro xyz) of the current still period
+    Running period_ = {0, {0, 0, 0, 0, 0, 0}};
+    // Samples of the current still period until it has lasted long enough
+    Running pending_ = {0, {0, 0, 0, 0, 0, 0}};
+    bool still_ = false;
+    uint32_t stillSince_ = 0;
+    uint32_t total_ = 0;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "CalibrationStore.hpp"
+
+#include <cstring>
+
+#include "Crc32.hpp"
+
+namespace {
+
+// Records are little endian regardless of the host
+void put32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+uint32_t get32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+
+void putFloat(uint8_t* p, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    put32(p, bits);
+}
+
+float getFloat(const uint8_t* p) {
+    uint32_t bits = get32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// [magic][sequence][address lo][address hi][acc bias xyz][gyro bias xyz][samples][crc]
+void encode(uint32_t sequence, uint64_t address, const SensorCalibration& calibration, uint8_t* p) {
+    put32(p, CALIBRATION_RECORD_MAGIC);
+    put32(p + 4, sequence);
+    put32(p + 8, static_cast<uint32_t>(address));
+    put32(p + 12, static_cast<uint32_t>(address >> 32));
+    for (int k = 0; k < 3; ++k) {
+        putFloat(p + 16 + 4 * k, calibration.accBias[k]);
+        putFloat(p + 28 + 4 * k, calibration.gyroBias[k]);
+    }
+    put32(p + 40, calibration.samples);
+    put32(p + 44, crc32(p, CALIBRATION_RECORD_SIZE - 4));
+}
+
+} // namespace
+
+int CalibrationStore::readRecord(uint32_t page, uint32_t slot, Record& record) {
+    uint8_t p[CALIBRATION_RECORD_SIZE];
+    if (!flash_.read(page * flash_.pageSize() + slot * CALIBRATION_RECORD_SIZE, p, sizeof(p))) return -1;
+    if (get32(p) == 0xffffffff) return 0;
+    if (get32(p) != CALIBRATION_RECORD_MAGIC || get32(p + 44) != crc32(p, CALIBRATION_RECORD_SIZE - 4)) return -1;
+    
+    record.sequence = get32(p + 4);
+    record.address = get32(p + 8) | (static_cast<uint64_t>(get32(p + 12)) << 32);
+    for (int k = 0; k < 3; ++k) {
+        record.calibration.accBias[k] = getFloat(p + 16 + 4 * k);
+        record.calibration.gyroBias[k] = getFloat(p + 28 + 4 * k);
+    }
+    record.calibration.samples = get32(p + 40);
+    return 1;
+}
+
+bool CalibrationStore::mount() {
+    mounted_ = false;
+    if (flash_.size() < 2 * flash_.pageSize() || recordsPerPage() == 0) return false;
+    
+    // Appending goes on in the page holding the newest record
+    bool found = false;
+    page_ = 0;
+    nextSlot_ = 0;
+    nextSequence_ = 0;
+    for (uint32_t page = 0; page < 2; ++page) {
+        uint32_t used = 0;
+        for (uint32_t slot = 0; slot < recordsPerPage(); ++slot) {
+            Record record;
+            int status = readRecord(page, slot, record);
+            if (status == 0) break;
+            used = slot + 1;
+            if (status == 1 && (!found || record.sequence >= nextSequence_)) {
+                found = true;
+                page_ = page;
+                nextSequence_ = record.sequence + 1;
+            }
+        }
+        if (found && page_ == page) {
+            nextSlot_ = used;
+        }
+    }
+    // Nothing valid stored: start over on a clean page
+    Record record;
+    if (!found && readRecord(0, 0, record) != 0 && !flash_.erase(0)) return false;
+    mounted_ = true;
+    return true;
+}
+
+bool CalibrationStore::load(uint64_t address, SensorCalibration& calibration) {
+    if (!mounted_) return false;
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint32_t page = 0; page < 2; ++page) {
+        for (uint32_t slot = 0; slot < recordsPerPage(); ++slot) {
+            Record record;
+            int status = readRecord(page, slot, record);
+            if (status == 0) break;
+            if (status == 1 && record.address == address && (!found || record.sequence >= newest)) {
+                found = true;
+                newest = record.sequence;
+                calibration = record.calibration;
+            }
+        }
+    }
+    return found;
+}
+
+bool CalibrationStore::writeRecord(const Record& record) {
+    uint8_t p[CALIBRATION_RECORD_SIZE];
+    encode(record.sequence, record.address, record.calibration, p);
+    if (!flash_.program(page_ * flash_.pageSize() + nextSlot_ * CALIBRATION_RECORD_SIZE, p, sizeof(p))) return false;
+    nextSlot_++;
+    return true;
+}
+
+bool CalibrationStore::save(uint64_t address, const SensorCalibration& calibration) {
+    if (!mounted_) return false;
+    
+    if (nextSlot_ >= recordsPerPage()) {
+        // The full page holds the newest record of every sensor
+        Record carried[CALIBRATION_MAX_SENSORS];
+        uint32_t carriedCount = 0;
+        for (uint32_t slot = 0; slot < recordsPerPage(); ++slot) {
+            Record record;
+            if (readRecord(page_, slot, record) != 1 || record.address == address) continue;
+            uint32_t i = 0;
+            while (i < carriedCount && carried[i].address != record.address) ++i;
+            if (i == carriedCount) {
+                if (carriedCount == CALIBRATION_MAX_SENSORS) continue;
+                carriedCount++;
+            }
+            carried[i] = record;
+        }
+        
+        page_ ^= 1;
+        nextSlot_ = 0;
+        if (!flash_.erase(page_ * flash_.pageSize())) return false;
+        for (uint32_t i = 0; i < carriedCount; ++i) {
+            carried[i].sequence = nextSequence_++;
+            if (!writeRecord(carried[i])) return false;
+        }
+    }
+    
+    Record record;
+    record.sequence = nextSequence_++;
+    record.address = address;
+    record.calibration = calibration;
+    return writeRecord(record);
+}
@@ -0,0 +1,51 @@
+#ifndef CALIBRATION_STORE_H
+#define CALIBRATION_STORE_H
+
+#include <cstdint>
+#include "Calibration.hpp"
+#include "Flash.hpp"
+
+// Region of internal flash for calibrations (2 pages of 4 KiB), stacked
+// directly below the event log
+#define CALIBRATION_FLASH_SIZE (2 * 4096)
+#define CALIBRATION_RECORD_MAGIC 0x42435841  // "AXCB"
+#define CALIBRATION_RECORD_SIZE 48
+// Distinct sensors whose calibration is carried over when a page fills up
+#define CALIBRATION_MAX_SENSORS 8
+
+// Sensor calibrations in flash, keyed by the sensor's 48-bit BLE address.
+//
+// Records are appended to one of two pages; the newest record of a sensor
+// wins. When the page is full, the other page is erased and the newest
+// record of every sensor is copied over before the new one is written, so
+// the page erased next never holds the only copy of a calibration. Each
+// record carries a CRC, so a record torn by power loss is ignored and the
+// sensor falls back to its previous calibration.
+class CalibrationStore {
+public:
+    explicit CalibrationStore(Flash& flash) : flash_(flash) {}
+    
+    bool mount();
+    bool load(uint64_t address, SensorCalibration& calibration);
+    bool save(uint64_t address, const SensorCalibration& calibration);
+    
+private:
+    struct Record {
+        uint32_t sequence;
+        uint64_t address;
+        SensorCalibration calibration;
+    };
+    
+    uint32_t recordsPerPage() const { return flash_.pageSize() / CALIBRATION_RECORD_SIZE; }
+    // Record slot of a page: 1 valid, 0 erased (end of page), -1 torn
+    int readRecord(uint32_t page, uint32_t slot, Record& record);
+    bool writeRecord(const Record& record);
+    
+    Flash& flash_;
+    bool mounted_ = false;
+    uint32_t page_ = 0;
+    uint32_t nextSlot_ = 0;
+    uint32_t nextSequence_ = 0;
+};
+
+#endif
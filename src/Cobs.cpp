@@ -0,0 +1,46 @@
+#include "Cobs.hpp"
+
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t codeIndex = 0;
+    size_t write = 1;
+    uint8_t code = 1;
+    
+    for (size_t i = 0; i < length; ++i) {
+        if (in[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = write++;
+            code = 1;
+            continue;
+        }
+        out[write++] = in[i];
+        if (++code == 0xff) {
+            // Maximum run: close the block and start another
+            out[codeIndex] = code;
+            codeIndex = write++;
+            code = 1;
+        }
+    }
+    out[codeIndex] = code;
+    return write;
+}
+
+size_t cobsDecode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t read = 0;
+    size_t write = 0;
+    
+    while (read < length) {
+        const uint8_t code = in[read++];
+        if (code == 0 || read + code - 1 > length) return 0;
+        
+        for (uint8_t i = 1; i < code; ++i) {
+            const uint8_t byte = in[read++];
+            if (byte == 0) return 0;
+            out[write++] = byte;
+        }
+        // A block shorter than the maximum stands for a zero, except at the end
+        if (code != 0xff && read < length) {
+            out[write++] = 0;
+        }
+    }
+    return write;
+}
@@ -0,0 +1,20 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Consistent Overhead Byte Stuffing: removes every 0x00 from a block so a
+// single 0x00 can delimit frames on a byte stream. Adds at most one byte
+// per 254 bytes of input, plus one.
+#define COBS_MAX_ENCODED_SIZE(n) ((n) + (n) / 254 + 1)
+
+// Encodes length bytes into out (COBS_MAX_ENCODED_SIZE(length) bytes),
+// without the trailing delimiter. Returns the encoded size.
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out);
+
+// Decodes one frame (without delimiter) into out, which may equal in.
+// Returns the decoded size, or 0 if the input is not valid COBS.
+size_t cobsDecode(const uint8_t* in, size_t length, uint8_t* out);
+
+#endif
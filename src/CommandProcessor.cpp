@@ -1,21 +1,25 @@
 #include "CommandProcessor.hpp"
 
-CommandProcessor::CommandProcessor(BLEManager* bleManager)
-  : bleManager(bleManager) {}
+CommandProcessor::CommandProcessor(BLEManager* bleManager, EventLog* eventLog, LatencyTrace* latencyTrace)
+  : bleManager(bleManager), eventLog(eventLog), latencyTrace(latencyTrace) {}
 
 const CommandProcessor::Command CommandProcessor::COMMANDS[] = {
   {"help", "Show available commands", "help", &CommandProcessor::helpHandler},
   {"scan", "Scan for BLE devices", "scan", &CommandProcessor::scanHandler},
   {"list", "List scanned devices", "list", &CommandProcessor::listHandler},
-  {"select", "Select a device to connect", "select <device index>", &CommandProcessor::selectHandler},
+  {"select", "Connect a device, or make a connected one the target of commands", "select <device index>", &CommandProcessor::selectHandler},
   {"services", "List services and characteristics", "services", &CommandProcessor::servicesHandler},
   {"subscribe", "Subscribe to a characteristic", "subscribe <service index> <characteristic index>", &CommandProcessor::subscribeHandler},
   {"unsubscribe", "Unsubscribe from a characteristic", "unsubscribe <service index> <characteristic index>", &CommandProcessor::unsubscribeHandler},
   {"read", "Read from a characteristic", "read <service index> <characteristic index>", &CommandProcessor::readHandler},
   {"write", "Write to a characteristic", "write <service index> <characteristic index> <hex data>", &CommandProcessor::writeHandler},
-  {"disconnect", "Disconnect from the device", "disconnect", &CommandProcessor::disconnectHandler},
-  {"movesense", "Send Movesense command", "movesense <service index>", &CommandProcessor::movesenseHandler},
-  {"auto", "Automatically connect and subscribe to Movesense", "auto", &CommandProcessor::autoHandler}
+  {"disconnect", "Disconnect from the selected device", "disconnect", &CommandProcessor::disconnectHandler},
+  {"sensors", "List connected sensors and their pipelines", "sensors", &CommandProcessor::sensorsHandler},
+  {"movesense", "Send Movesense command", "movesense <hello|subscribe [rate]|unsubscribe>", &CommandProcessor::movesenseHandler},
+  {"auto", "Automatically connect and subscribe to Movesense", "auto", &CommandProcessor::autoHandler},
+  {"log", "Show, dump or clear the impact event log", "log <info|show|dump|clear>", &CommandProcessor::logHandler},
+  {"stats", "Show and reset per-stage timing (needs AXONA_PROFILE)", "stats", &CommandProcessor::statsHandler},
+  {"trace", "Dump or clear the impact latency trace", "trace <dump|clear>", &CommandProcessor::traceHandler}
 };
 
 const int CommandProcessor::COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
@@ -167,33 +171,70 @@ bool CommandProcessor::disconnectHandler(int argc, char** argv) {
   return true;
 }
 
+bool CommandProcessor::sensorsHandler(int argc, char** argv) {
+  for (int i = 0; i < SENSOR_MAX_DEVICES; i++) {
+    const BLEManager::Connection& connection = BLEManager::connection(i);
+    Serial.print("[");
+    Serial.print(i);
+    Serial.print("] ");
+    if (!connection.device || !connection.pipeline) {
+      Serial.println("free");
+      continue;
+    }
+    const SensorPipeline& pipeline = *connection.pipeline;
+    Serial.print(connection.device.address());
+    Serial.print(connection.linkLost ? " reconnecting" : connection.subscribed ? " streaming" : " idle");
+    Serial.print(" pipeline ");
+    Serial.print(pipeline.id);
+    Serial.print(" samples ");
+    Serial.print(pipeline.queue.pushed());
+    Serial.print(" dropped ");
+    Serial.print(pipeline.queue.dropped());
+    Serial.print(" rate ");
+    Serial.print(connection.sampleRate);
+    Serial.print(" rateChanges ");
+    Serial.print(connection.rateChanges);
+    Serial.print(" reconnects ");
+    Serial.print(connection.reconnects);
+    Serial.print(" gaps ");
+    Serial.print(pipeline.processor.getSampleGaps());
+    Serial.print(" relocks ");
+    Serial.print(pipeline.sampleClock.relocks());
+    // Sensor clock to receiver micros(), for correlating impacts across sensors
+    Serial.print(" clockOffsetUs ");
+    if (pipeline.clock.valid()) {
+      Serial.println(pipeline.clock.offsetUs());
+    } else {
+      Serial.println("-");
+    }
+  }
+  return true;
+}
+
 bool CommandProcessor::movesenseHandler(int argc, char** argv) {
   if (argc < 1) return false;
   
   String subcommand = argv[0];
 
-  int serviceIndex = 5;
-  int notifyCharIndex = 1;
-  int writeCharIndex = 0; 
-  
+  // The GSP characteristics are resolved by UUID once per connection
   if (subcommand == "hello") {
     const uint8_t helloMessage[] = {0, 123};
-    bleManager->subscribeCharacteristic(serviceIndex, notifyCharIndex);
-    bleManager->writeCharacteristic(serviceIndex, writeCharIndex, helloMessage, sizeof(helloMessage));
+    bleManager->subscribeSensorData();
+    bleManager->writeSensorCommand(helloMessage, sizeof(helloMessage));
     Serial.println("Sent hello command to Movesense");
   }
   else if (subcommand == "subscribe") {
-    String sampleRate = argv[1];
-    const uint8_t subscribeCommand[] = {1, 99, '/', 'M', 'e', 'a', 's', '/', 'I', 'M', 'U', '6', '/', sampleRate.charAt(0), sampleRate.charAt(1), sampleRate.charAt(2), sampleRate.charAt(3)};
-    int commandLength = 13 + sampleRate.length();
-    bleManager->writeCharacteristic(serviceIndex, writeCharIndex, subscribeCommand, commandLength);
-    bleManager->subscribeCharacteristic(serviceIndex, notifyCharIndex);
+    int sampleRate = argc > 1 ? atoi(argv[1]) : RATE_TIER_RIDING;
+    uint8_t subscribeCommand[IMU6_COMMAND_MAX];
+    int commandLength = imu6SubscribeCommand(subscribeCommand, STREAM_REFERENCE, sampleRate);
+    if (!bleManager->startSensorStream(subscribeCommand, commandLength, sampleRate)) {
+      Serial.println("Failed to subscribe to IMU sensor");
+      return false;
+    }
     Serial.println("Subscribed to IMU sensor");
   }
   else if (subcommand == "unsubscribe") {
-    const uint8_t unsubscribeCommand[] = {2, 99};
-    bleManager->writeCharacteristic(serviceIndex, writeCharIndex, unsubscribeCommand, sizeof(unsubscribeCommand));
-    bleManager->unsubscribeCharacteristic(serviceIndex, notifyCharIndex);
+    bleManager->stopSensorStream();
     Serial.println("Unsubscribed from IMU sensor");
   }
   else {
@@ -201,18 +242,15 @@ bool CommandProcessor::movesenseHandler(int argc, char** argv) {
     Serial.println(subcommand);
     return false;
   }
-
+  return true;
 }
 
 bool CommandProcessor::autoHandler(int argc, char** argv) {
-  // Execute "scan"
-  if (!scanHandler(0, nullptr)) {
-    Serial.println("Failed to scan for devices.");
-    return false;
-  }
+  // Scan until the target shows up (at most SCAN_TIME)
+  const char* targetAddress = "74:92:ba:10:e8:23";
+  bleManager->scanDevices(&targetAddress, 1);
 
   // Find and select the device with the specific address
-  const char* targetAddress = "74:92:ba:10:e8:23";
   int targetIndex = bleManager->getDeviceIndex(targetAddress);
   if (targetIndex == -1) {
     Serial.println("Target device not found.");
@@ -236,13 +274,170 @@ bool CommandProcessor::autoHandler(int argc, char** argv) {
     return false;
   }
 
-  // Execute "movesense subscribe"
-  const char* movesenseArgs[] = {"subscribe", "52"};
-  if (!movesenseHandler(1, const_cast<char**>(movesenseArgs))) {
+  // Execute "movesense subscribe"; the rate then follows the motion
+  char rateStr[8];
+  snprintf(rateStr, sizeof(rateStr), "%d", RATE_TIER_RIDING);
+  const char* movesenseArgs[] = {"subscribe", rateStr};
+  if (!movesenseHandler(2, const_cast<char**>(movesenseArgs))) {
     Serial.println("Failed to subscribe to Movesense.");
     return false;
   }
 
   Serial.println("Auto command executed successfully.");
   return true;
-}
\ No newline at end of file
+}
+// Writes one raw log frame to Serial
+static bool dumpFrame(const uint8_t* frame, size_t length, void* context) {
+  Serial.write(frame, length);
+  return true;
+}
+
+// Prints one decoded log record as a line of text
+static bool showFrame(const uint8_t* frame, size_t length, void* context) {
+  ImpactRecord record;
+  if (!EventLog::decode(frame, length, record)) return true;
+
+  Serial.print("#");
+  Serial.print(static_cast<unsigned long>(record.sequence));
+  Serial.print(" sensor=");
+  Serial.print(static_cast<int>(record.sensor));
+  Serial.print(" t=");
+  Serial.print(static_cast<unsigned long>(record.triggerTime));
+  Serial.print(" level=");
+  Serial.print(static_cast<int>(record.level));
+  Serial.print(" hic15=");
+  Serial.print(record.hic15, 2);
+  Serial.print(" hic36=");
+  Serial.print(record.hic36, 2);
+  Serial.print(" peak=");
+  Serial.print(record.peakAcc, 2);
+  Serial.print(" riding=");
+  Serial.print(record.ridingVelocity, 2);
+  Serial.print(" head=");
+  Serial.println(record.headVelocity, 2);
+  return true;
+}
+
+bool CommandProcessor::logHandler(int argc, char** argv) {
+  if (argc != 1) return false;
+  if (eventLog == nullptr) {
+    Serial.println("Event log not available");
+    return true;
+  }
+
+  if (strcmp(argv[0], "info") == 0) {
+    EventLog::Stats stats = eventLog->stats();
+    Serial.print("Records: ");
+    Serial.print(static_cast<unsigned long>(stats.records));
+    Serial.print(" (torn: ");
+    Serial.print(static_cast<unsigned long>(stats.tornRecords));
+    Serial.println(")");
+    Serial.print("Pages used: ");
+    Serial.print(static_cast<unsigned long>(stats.usedPages));
+    Serial.print("/");
+    Serial.print(static_cast<unsigned long>(stats.pages));
+    Serial.print(", bytes: ");
+    Serial.println(static_cast<unsigned long>(stats.bytesUsed));
+    Serial.print("Page erases: ");
+    Serial.print(static_cast<unsigned long>(stats.minEraseCount));
+    Serial.print("-");
+    Serial.println(static_cast<unsigned long>(stats.maxEraseCount));
+  }
+  else if (strcmp(argv[0], "show") == 0) {
+    eventLog->forEach(showFrame, nullptr);
+  }
+  else if (strcmp(argv[0], "dump") == 0) {
+    // Raw frames between a text header and four zero bytes; frames carry
+    // their own length and CRC (see EventLog::decode)
+    Serial.println("EVENTLOG BEGIN");
+    size_t count = eventLog->forEach(dumpFrame, nullptr);
+    const uint8_t end[4] = {0, 0, 0, 0};
+    Serial.write(end, sizeof(end));
+    Serial.println();
+    Serial.print("EVENTLOG END ");
+    Serial.println(static_cast<unsigned long>(count));
+  }
+  else if (strcmp(argv[0], "clear") == 0) {
+    Serial.println(eventLog->format() ? "Event log cleared" : "Failed to clear event log");
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+bool CommandProcessor::statsHandler(int argc, char** argv) {
+  if (argc != 0) return false;
+#ifdef AXONA_PROFILE
+  for (int i = 0; i < static_cast<int>(ProfileStage::COUNT); i++) {
+    const ProfileStage stage = static_cast<ProfileStage>(i);
+    const ProfileStats& stats = profiler::stats(stage);
+    Serial.print(profiler::stageName(stage));
+    Serial.print(": n ");
+    Serial.print(static_cast<unsigned long>(stats.count));
+    if (stats.count == 0) {
+      Serial.println();
+      continue;
+    }
+    Serial.print(" min ");
+    Serial.print(static_cast<unsigned long>(stats.minCycles));
+    Serial.print(" mean ");
+    Serial.print(static_cast<unsigned long>(stats.totalCycles / stats.count));
+    Serial.print(" max ");
+    Serial.print(static_cast<unsigned long>(stats.maxCycles));
+    Serial.print(" ");
+    Serial.println(profiler::unit());
+
+    // Non-empty log2 buckets as "2^k:count"
+    Serial.print(" ");
+    for (int k = 0; k < PROFILE_BUCKETS; k++) {
+      if (stats.buckets[k] == 0) continue;
+      Serial.print(" 2^");
+      Serial.print(k);
+      Serial.print(":");
+      Serial.print(static_cast<unsigned long>(stats.buckets[k]));
+    }
+    Serial.println();
+  }
+  profiler::reset();
+#else
+  Serial.println("Profiling not compiled in (build with AXONA_PROFILE)");
+#endif
+  return true;
+}
+
+bool CommandProcessor::traceHandler(int argc, char** argv) {
+  if (argc != 1) return false;
+  if (latencyTrace == nullptr) {
+    Serial.println("Latency trace not available");
+    return true;
+  }
+
+  if (strcmp(argv[0], "dump") == 0) {
+    // One "sensor,stage,sensor us,receiver us" line per entry, oldest
+    // first; host/trace/latency_report turns this into latencies
+    Serial.println("TRACE BEGIN");
+    for (size_t i = 0; i < latencyTrace->size(); i++) {
+      const TraceEntry& entry = latencyTrace->at(i);
+      Serial.print(entry.sensor);
+      Serial.print(",");
+      Serial.print(LatencyTrace::stageName(static_cast<TraceStage>(entry.stage)));
+      Serial.print(",");
+      Serial.print(static_cast<unsigned long>(entry.sensorUs));
+      Serial.print(",");
+      Serial.println(static_cast<unsigned long>(entry.receiverUs));
+    }
+    Serial.print("TRACE END ");
+    Serial.print(static_cast<unsigned long>(latencyTrace->size()));
+    Serial.print(" overwritten ");
+    Serial.println(static_cast<unsigned long>(latencyTrace->overwritten()));
+  }
+  else if (strcmp(argv[0], "clear") == 0) {
+    latencyTrace->clear();
+    Serial.println("Latency trace cleared");
+  }
+  else {
+    return false;
+  }
+  return true;
+}
@@ -3,11 +3,16 @@
 
 #include <Arduino.h>
 #include "BLEManager.hpp"
+#include "EventLog.hpp"
+#include "LatencyTrace.hpp"
+#include "Profiler.hpp"
+#include "RateController.hpp"
 
 class CommandProcessor {
 public:
-  static CommandProcessor& getInstance(BLEManager* bleManager = nullptr) {
-    static CommandProcessor instance(bleManager);
+  static CommandProcessor& getInstance(BLEManager* bleManager = nullptr, EventLog* eventLog = nullptr,
+                                       LatencyTrace* latencyTrace = nullptr) {
+    static CommandProcessor instance(bleManager, eventLog, latencyTrace);
     return instance;
   }
   
@@ -24,7 +29,7 @@ private:
     CommandHandler handler;
   };
 
-  CommandProcessor(BLEManager* bleManager);
+  CommandProcessor(BLEManager* bleManager, EventLog* eventLog, LatencyTrace* latencyTrace);
   CommandProcessor(const CommandProcessor&) = delete;
   CommandProcessor& operator=(const CommandProcessor&) = delete;
 
@@ -41,10 +46,16 @@ private:
   bool readHandler(int argc, char** argv);
   bool writeHandler(int argc, char** argv);
   bool disconnectHandler(int argc, char** argv);
+  bool sensorsHandler(int argc, char** argv);
   bool movesenseHandler(int argc, char** argv);
   bool autoHandler(int argc, char** argv);
+  bool logHandler(int argc, char** argv);
+  bool statsHandler(int argc, char** argv);
+  bool traceHandler(int argc, char** argv);
   
   BLEManager* bleManager;
+  EventLog* eventLog;
+  LatencyTrace* latencyTrace;
   static const Command COMMANDS[];
   static const int COMMAND_COUNT;
 };
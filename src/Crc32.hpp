@@ -0,0 +1,11 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3, reflected, as used by zlib). Pass the previous
+// result as crc to continue over several buffers.
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef DATA_VIEW_H
+#define DATA_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Bounds-checked little-endian reader over a raw notification payload
+class DataView {
+private:
+    const uint8_t* buffer_;
+    const size_t length_;
+
+public:
+    DataView(const uint8_t* buffer, size_t length)
+        : buffer_(buffer), length_(length) {}
+
+    bool checkBounds(size_t startIndex, size_t byteCount) const {
+        return (startIndex + byteCount) <= length_;
+    }
+
+    uint8_t getUint8(size_t startIndex) const {
+        if (!checkBounds(startIndex, 1)) return 0;
+        return buffer_[startIndex];
+    }
+
+    uint16_t getUint16(size_t startIndex) const {
+        if (!checkBounds(startIndex, 2)) return 0;
+        uint16_t value;
+        memcpy(&value, buffer_ + startIndex, sizeof(value));
+        return value;
+    }
+
+    uint32_t getUint32(size_t startIndex) const {
+        if (!checkBounds(startIndex, 4)) return 0;
+        uint32_t value;
+        memcpy(&value, buffer_ + startIndex, sizeof(value));
+        return value;
+    }
+
+    int32_t getInt32(size_t startIndex) const {
+        if (!checkBounds(startIndex, 4)) return 0;
+        int32_t value;
+        memcpy(&value, buffer_ + startIndex, sizeof(value));
+        return value;
+    }
+
+    float getFloat32(size_t startIndex) const {
+        if (!checkBounds(startIndex, 4)) return 0.0f;
+        float value;
+        memcpy(&value, buffer_ + startIndex, sizeof(value));
+        return value;
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "EventCapture.hpp"
+
+SampleWindow ImpactEvent::postTrigger() const {
+    SampleWindow w;
+    w.begin = triggerIndex;
+    w.end = samples.size();
+    return w;
+}
+
+Scalar ImpactEvent::ridingVelocity() const {
+    uint32_t end = triggerTime - 5000000;
+    return speeds.average(end - 4000000, end);
+}
+
+SampleWindow ImpactEvent::headWindow() const {
+    uint32_t end = triggerTime - 100000;
+    return window(end - 100000, end);
+}
+
+void EventCapture::reset() {
+    event_.samples.clear();
+    event_.speeds.clear();
+    event_.triggerTime = 0;
+    event_.triggerIndex = 0;
+    state_ = State::IDLE;
+    missed_ = 0;
+    captured_ = 0;
+}
+
+void EventCapture::trigger(const SampleBuffer& live, const VelocityHistory& speeds, uint32_t triggerTime) {
+    if (state_ != State::IDLE) {
+        missed_++;
+        return;
+    }
+    
+    event_.triggerTime = triggerTime;
+    event_.samples.assign(live, live.window(triggerTime - preTriggerMs_ * 1000u, triggerTime));
+    event_.triggerIndex = event_.samples.empty() ? 0 : event_.samples.size() - 1;
+    event_.speeds = speeds;
+    captured_++;
+    state_ = postTriggerMs_ > 0 ? State::FILLING : State::READY;
+}
+
+void EventCapture::append(const IMUData& data) {
+    if (state_ != State::FILLING) return;
+    
+    // A full record drops its oldest pre-trigger sample
+    if (event_.samples.full() && event_.triggerIndex > 0) {
+        event_.triggerIndex--;
+    }
+    event_.samples.push(data);
+    
+    if (data.timestamp - event_.triggerTime >= postTriggerMs_ * 1000u) {
+        state_ = State::READY;
+    }
+}
+
+void EventCapture::release() {
+    if (state_ == State::READY) {
+        state_ = State::IDLE;
+    }
+}
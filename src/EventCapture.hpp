@@ -0,0 +1,83 @@
+#ifndef EVENT_CAPTURE_H
+#define EVENT_CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SampleBuffer.hpp"
+#include "VelocityHistory.hpp"
+
+// Samples held by one event record
+#define EVENT_CAPTURE_SIZE 500
+// Default span copied from before the trigger; covers the head-velocity
+// window and the event log snapshot. The riding velocity, 9 s to 5 s
+// before the trigger, comes from the VelocityHistory instead.
+#define EVENT_PRE_TRIGGER_MS 1000
+// Default span recorded after the trigger; longer than the HIC36 window so
+// the peak following the threshold crossing is inside the record
+#define EVENT_POST_TRIGGER_MS 50
+
+// A frozen impact: the samples around the trigger and the speed history
+// up to it, unaffected by later processing. The trigger sample is at
+// triggerIndex; times are in µs.
+struct ImpactEvent {
+    uint32_t triggerTime = 0;
+    size_t triggerIndex = 0;
+    StaticSampleBuffer<EVENT_CAPTURE_SIZE> samples;
+    VelocityHistory speeds;
+    
+    // Logical window of the record, for use with the ImpactMetrics functions
+    SampleWindow window(uint32_t from, uint32_t to) const { return samples.window(from, to); }
+    
+    // Windows the impact metrics are evaluated over
+    SampleWindow postTrigger() const;     // trigger sample to end of record (HIC, level)
+    SampleWindow headWindow() const;      // 200 ms to 100 ms before the trigger
+    // Mean speed 9 s to 5 s before the trigger, from the speed history
+    Scalar ridingVelocity() const;
+};
+
+// Captures one impact at a time into a preallocated record.
+//
+// trigger() copies the pre-trigger span out of the live buffer, and the
+// speed history; append()
+// then records samples until the post-trigger span is complete. The record
+// stays frozen until the consumer calls release(). Triggers arriving while
+// the record is busy are counted in missed().
+class EventCapture {
+public:
+    enum class State : uint8_t {
+        IDLE,
+        FILLING,
+        READY
+    };
+    
+    void configure(uint32_t preTriggerMs, uint32_t postTriggerMs) {
+        preTriggerMs_ = preTriggerMs;
+        postTriggerMs_ = postTriggerMs;
+    }
+    void reset();
+    
+    // The triggering sample must already be the newest sample in live
+    void trigger(const SampleBuffer& live, const VelocityHistory& speeds, uint32_t triggerTime);
+    // Feed each sample after the trigger while the state is FILLING
+    void append(const IMUData& data);
+    
+    State state() const { return state_; }
+    bool filling() const { return state_ == State::FILLING; }
+    // Completed record, or nullptr
+    const ImpactEvent* ready() const { return state_ == State::READY ? &event_ : nullptr; }
+    void release();
+    uint32_t missed() const { return missed_; }
+    // Triggers that started a record, and the latest one's time
+    uint32_t captured() const { return captured_; }
+    uint32_t triggerTime() const { return event_.triggerTime; }
+    
+private:
+    ImpactEvent event_;
+    State state_ = State::IDLE;
+    uint32_t preTriggerMs_ = EVENT_PRE_TRIGGER_MS;
+    uint32_t postTriggerMs_ = EVENT_POST_TRIGGER_MS;
+    uint32_t missed_ = 0;
+    uint32_t captured_ = 0;
+};
+
+#endif
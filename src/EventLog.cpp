@@ -0,0 +1,313 @@
+#include "EventLog.hpp"
+
+#include <cstring>
+
+#include "Crc32.hpp"
+
+namespace {
+
+// Frames are little endian regardless of the host
+void put16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+void put32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+uint16_t get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t get32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+
+void putFloat(uint8_t* p, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    put32(p, bits);
+}
+
+float getFloat(const uint8_t* p) {
+    uint32_t bits = get32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+uint32_t align4(uint32_t n) { return (n + 3) & ~3u; }
+
+uint32_t headerCrc(const uint8_t* bytes) {
+    return crc32(bytes, EVENT_LOG_PAGE_HEADER_SIZE - 4);
+}
+
+} // namespace
+
+ImpactRecord makeImpactRecord(const ImpactEvent& event, const ImpactReport& report) {
+    ImpactRecord record;
+    record.triggerTime = report.triggerTime;
+    record.level = static_cast<uint8_t>(report.level);
+    record.hic15 = static_cast<float>(report.hic.hic15);
+    record.hic36 = static_cast<float>(report.hic.hic36);
+    record.peakAcc = static_cast<float>(report.peakAcc);
+    record.ridingVelocity = static_cast<float>(report.ridingVelocity);
+    record.headVelocity = static_cast<float>(report.headVelocity);
+    
+    for (int i = 0; i < EVENT_LOG_SNAPSHOT_BINS; ++i) {
+        record.snapshot[i] = EVENT_LOG_SNAPSHOT_EMPTY;
+    }
+    record.snapshotCount = EVENT_LOG_SNAPSHOT_BINS;
+    record.snapshotStartMs = -EVENT_LOG_SNAPSHOT_PRE_MS;
+    
+    const SampleBuffer& samples = event.samples;
+    if (samples.empty()) return record;
+    
+    // Peak per bin, so short spikes survive the down-sampling
+    const uint32_t start = event.triggerTime - EVENT_LOG_SNAPSHOT_PRE_MS * 1000u;
+    const uint32_t spanUs = samples.back().timestamp - start + 1;
+    const uint32_t binUs = (spanUs + EVENT_LOG_SNAPSHOT_BINS - 1) / EVENT_LOG_SNAPSHOT_BINS;
+    record.snapshotBinUs = binUs > 0xffff ? 0xffff : static_cast<uint16_t>(binUs);
+    
+    SampleWindow window = samples.window(start, samples.back().timestamp);
+    for (size_t i = window.begin; i < window.end; ++i) {
+        uint32_t bin = (samples.timestamp(i) - start) / record.snapshotBinUs;
+        if (bin >= EVENT_LOG_SNAPSHOT_BINS) bin = EVENT_LOG_SNAPSHOT_BINS - 1;
+        
+        Scalar centi = samples.linAcc(i) * S(100) + S(0.5);
+        uint16_t value = centi >= S(EVENT_LOG_SNAPSHOT_EMPTY - 1) ? EVENT_LOG_SNAPSHOT_EMPTY - 1
+                                                                  : static_cast<uint16_t>(centi);
+        if (record.snapshot[bin] == EVENT_LOG_SNAPSHOT_EMPTY || value > record.snapshot[bin]) {
+            record.snapshot[bin] = value;
+        }
+    }
+    return record;
+}
+
+size_t EventLog::frameSize(const uint8_t* header) {
+    uint16_t length = get16(header);
+    if (length == 0 || length > EVENT_LOG_MAX_FRAME_SIZE - 8) return 0;
+    return 4 + align4(length) + 4;
+}
+
+size_t EventLog::encode(const ImpactRecord& record, uint8_t* frame) {
+    const uint32_t payloadSize = EVENT_LOG_IMPACT_HEADER_SIZE + 2 * record.snapshotCount;
+    const size_t size = 4 + align4(payloadSize) + 4;
+    std::memset(frame, 0, size);
+    
+    put16(frame, payloadSize);
+    frame[2] = EVENT_LOG_RECORD_IMPACT;
+    frame[3] = EVENT_LOG_VERSION;
+    
+    uint8_t* p = frame + 4;
+    put32(p, record.sequence);
+    put32(p + 4, record.triggerTime);
+    p[8] = record.level;
+    p[9] = record.snapshotCount;
+    put16(p + 10, static_cast<uint16_t>(record.snapshotStartMs));
+    put16(p + 12, record.snapshotBinUs);
+    putFloat(p + 14, record.hic15);
+    putFloat(p + 18, record.hic36);
+    putFloat(p + 22, record.peakAcc);
+    putFloat(p + 26, record.ridingVelocity);
+    putFloat(p + 30, record.headVelocity);
+    p[34] = record.sensor;
+    for (int i = 0; i < record.snapshotCount; ++i) {
+        put16(p + EVENT_LOG_IMPACT_HEADER_SIZE + 2 * i, record.snapshot[i]);
+    }
+    
+    put32(frame + size - 4, crc32(frame, size - 4));
+    return size;
+}
+
+bool EventLog::decode(const uint8_t* frame, size_t length, ImpactRecord& record) {
+    if (length < 8) return false;
+    const size_t size = frameSize(frame);
+    if (size == 0 || size > length) return false;
+    if (get32(frame + size - 4) != crc32(frame, size - 4)) return false;
+    if (frame[2] != EVENT_LOG_RECORD_IMPACT || frame[3] != EVENT_LOG_VERSION) return false;
+    
+    const size_t headerSize = EVENT_LOG_IMPACT_HEADER_SIZE;
+    const uint16_t payloadSize = get16(frame);
+    const uint8_t* p = frame + 4;
+    if (payloadSize < headerSize || p[9] > EVENT_LOG_SNAPSHOT_BINS || payloadSize != headerSize + 2 * p[9]) return false;
+    
+    record.sequence = get32(p);
+    record.triggerTime = get32(p + 4);
+    record.level = p[8];
+    record.snapshotCount = p[9];
+    record.snapshotStartMs = static_cast<int16_t>(get16(p + 10));
+    record.snapshotBinUs = get16(p + 12);
+    record.hic15 = getFloat(p + 14);
+    record.hic36 = getFloat(p + 18);
+    record.peakAcc = getFloat(p + 22);
+    record.ridingVelocity = getFloat(p + 26);
+    record.headVelocity = getFloat(p + 30);
+    record.sensor = p[34];
+    for (int i = 0; i < record.snapshotCount; ++i) {
+        record.snapshot[i] = get16(p + headerSize + 2 * i);
+    }
+    return true;
+}
+
+bool EventLog::readHeader(uint32_t page, PageHeader& header) {
+    uint8_t bytes[EVENT_LOG_PAGE_HEADER_SIZE];
+    if (!flash_.read(page * flash_.pageSize(), bytes, sizeof(bytes))) return false;
+    header.magic = get32(bytes);
+    header.pageSequence = get32(bytes + 4);
+    header.eraseCount = get32(bytes + 8);
+    header.firstSequence = get32(bytes + 12);
+    header.crc = get32(bytes + 16);
+    return header.magic == EVENT_LOG_PAGE_MAGIC && header.crc == headerCrc(bytes);
+}
+
+bool EventLog::startPage(uint32_t page) {
+    PageHeader old;
+    uint32_t eraseCount = readHeader(page, old) ? old.eraseCount + 1 : maxEraseCount_;
+    if (!flash_.erase(page * flash_.pageSize())) return false;
+    
+    uint8_t bytes[EVENT_LOG_PAGE_HEADER_SIZE];
+    const uint32_t pageSequence = hasHead_ ? headPageSequence_ + 1 : 0;
+    put32(bytes, EVENT_LOG_PAGE_MAGIC);
+    put32(bytes + 4, pageSequence);
+    put32(bytes + 8, eraseCount);
+    put32(bytes + 12, nextSequence_);
+    put32(bytes + 16, headerCrc(bytes));
+    if (!flash_.program(page * flash_.pageSize(), bytes, sizeof(bytes))) return false;
+    
+    hasHead_ = true;
+    headPage_ = page;
+    headPageSequence_ = pageSequence;
+    writeOffset_ = EVENT_LOG_PAGE_HEADER_SIZE;
+    if (eraseCount > maxEraseCount_) maxEraseCount_ = eraseCount;
+    return true;
+}
+
+uint32_t EventLog::scanPage(uint32_t page, FrameVisitor visit, void* context,
+                            uint32_t* valid, uint32_t* torn, uint32_t* lastSequence, bool* stopped) {
+    const uint32_t pageSize = flash_.pageSize();
+    const uint32_t base = page * pageSize;
+    uint32_t offset = EVENT_LOG_PAGE_HEADER_SIZE;
+    uint8_t frame[EVENT_LOG_MAX_FRAME_SIZE];
+    
+    while (offset + 8 <= pageSize) {
+        if (!flash_.read(base + offset, frame, 4)) return pageSize;
+        if (get32(frame) == 0xffffffff) return offset;  // erased: end of the page's records
+        
+        // A frame header that is not erased but invalid was torn mid-word;
+        // nothing after it can be trusted, so treat the page as full
+        const size_t size = frameSize(frame);
+        if (size == 0 || offset + size > pageSize) return pageSize;
+        
+        if (!flash_.read(base + offset + 4, frame + 4, size - 4)) return pageSize;
+        if (get32(frame + size - 4) == crc32(frame, size - 4)) {
+            if (valid) (*valid)++;
+            if (lastSequence) *lastSequence = get32(frame + 4);
+            if (visit && !visit(frame, size, context)) {
+                if (stopped) *stopped = true;
+                return offset + size;
+            }
+        } else if (torn) {
+            (*torn)++;
+        }
+        offset += size;
+    }
+    return pageSize;
+}
+
+bool EventLog::mount() {
+    const uint32_t pages = pageCount();
+    if (pages < 2 || flash_.pageSize() < EVENT_LOG_PAGE_HEADER_SIZE + EVENT_LOG_MAX_FRAME_SIZE) return false;
+    
+    hasHead_ = false;
+    maxEraseCount_ = 0;
+    nextSequence_ = 0;
+    
+    // The newest page has the highest page sequence
+    PageHeader header;
+    for (uint32_t page = 0; page < pages; ++page) {
+        if (!readHeader(page, header)) continue;
+        if (header.eraseCount > maxEraseCount_) maxEraseCount_ = header.eraseCount;
+        if (!hasHead_ || static_cast<int32_t>(header.pageSequence - headPageSequence_) > 0) {
+            hasHead_ = true;
+            headPage_ = page;
+            headPageSequence_ = header.pageSequence;
+            nextSequence_ = header.firstSequence;
+        }
+    }
+    
+    if (hasHead_) {
+        uint32_t valid = 0;
+        uint32_t lastSequence = 0;
+        writeOffset_ = scanPage(headPage_, nullptr, nullptr, &valid, nullptr, &lastSequence, nullptr);
+        if (valid > 0 && static_cast<int32_t>(lastSequence + 1 - nextSequence_) > 0) {
+            nextSequence_ = lastSequence + 1;
+        }
+    }
+    
+    mounted_ = true;
+    return true;
+}
+
+bool EventLog::format() {
+    for (uint32_t page = 0; page < pageCount(); ++page) {
+        if (!flash_.erase(page * flash_.pageSize())) return false;
+    }
+    hasHead_ = false;
+    nextSequence_ = 0;
+    maxEraseCount_ = 0;
+    mounted_ = true;
+    return true;
+}
+
+bool EventLog::prepare() {
+    if (!mounted_) return false;
+    if (hasHead_ && writeOffset_ + EVENT_LOG_MAX_FRAME_SIZE <= flash_.pageSize()) return true;
+    return startPage(hasHead_ ? (headPage_ + 1) % pageCount() : 0);
+}
+
+bool EventLog::append(ImpactRecord& record) {
+    if (!mounted_) return false;
+    
+    record.sequence = nextSequence_;
+    uint8_t frame[EVENT_LOG_MAX_FRAME_SIZE];
+    const size_t size = encode(record, frame);
+    
+    // Usually done ahead of time by prepare()
+    if (!hasHead_ || writeOffset_ + size > flash_.pageSize()) {
+        if (!startPage(hasHead_ ? (headPage_ + 1) % pageCount() : 0)) return false;
+    }
+    
+    const uint32_t address = headPage_ * flash_.pageSize() + writeOffset_;
+    // Whatever happens, the space is consumed; a partial frame fails its CRC
+    writeOffset_ += size;
+    if (!flash_.program(address, frame, size)) return false;
+    
+    nextSequence_++;
+    return true;
+}
+
+size_t EventLog::forEach(FrameVisitor visit, void* context) {
+    if (!mounted_ || !hasHead_) return 0;
+    
+    // Oldest page first: the ring continues after the head page
+    const uint32_t pages = pageCount();
+    uint32_t count = 0;
+    bool stopped = false;
+    PageHeader header;
+    for (uint32_t i = 1; i <= pages && !stopped; ++i) {
+        const uint32_t page = (headPage_ + i) % pages;
+        if (!readHeader(page, header)) continue;
+        scanPage(page, visit, context, &count, nullptr, nullptr, &stopped);
+    }
+    return count;
+}
+
+EventLog::Stats EventLog::stats() {
+    Stats s = {};
+    s.pages = pageCount();
+    s.minEraseCount = 0xffffffff;
+    
+    PageHeader header;
+    for (uint32_t page = 0; page < s.pages; ++page) {
+        if (!readHeader(page, header)) {
+            s.minEraseCount = 0;
+            continue;
+        }
+        s.usedPages++;
+        if (header.eraseCount < s.minEraseCount) s.minEraseCount = header.eraseCount;
+        if (header.eraseCount > s.maxEraseCount) s.maxEraseCount = header.eraseCount;
+        s.bytesUsed += scanPage(page, nullptr, nullptr, &s.records, &s.tornRecords, nullptr, nullptr);
+    }
+    if (s.minEraseCount == 0xffffffff) s.minEraseCount = 0;
+    return s;
+}
@@ -0,0 +1,121 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include "EventCapture.hpp"
+#include "Flash.hpp"
+#include "MetricJob.hpp"
+
+// Region of internal flash used by the log (16 pages of 4 KiB)
+#define EVENT_LOG_FLASH_SIZE (16 * 4096)
+// Layout of the impact records; records of any other version do not decode
+#define EVENT_LOG_VERSION 1
+#define EVENT_LOG_PAGE_MAGIC 0x474c5841  // "AXLG"
+#define EVENT_LOG_PAGE_HEADER_SIZE 20
+// Bins of the down-sampled linear acceleration snapshot
+#define EVENT_LOG_SNAPSHOT_BINS 32
+// The snapshot starts this long before the trigger and ends with the record
+#define EVENT_LOG_SNAPSHOT_PRE_MS 100
+// Snapshot bin without any sample
+#define EVENT_LOG_SNAPSHOT_EMPTY 0xffff
+#define EVENT_LOG_RECORD_IMPACT 1
+// Frame = 4-byte header + payload padded to 4 bytes + CRC-32
+#define EVENT_LOG_IMPACT_HEADER_SIZE 35
+#define EVENT_LOG_IMPACT_PAYLOAD_SIZE (EVENT_LOG_IMPACT_HEADER_SIZE + 2 * EVENT_LOG_SNAPSHOT_BINS)
+#define EVENT_LOG_MAX_FRAME_SIZE (4 + ((EVENT_LOG_IMPACT_PAYLOAD_SIZE + 3) & ~3) + 4)
+
+// One logged impact. Metrics are stored as float whatever Scalar is, so
+// the format does not depend on the build.
+struct ImpactRecord {
+    uint32_t sequence = 0;        // assigned by EventLog::append
+    uint32_t triggerTime = 0;     // sensor clock, µs
+    uint8_t sensor = 0;           // SensorHub pipeline that saw the impact
+    uint8_t level = 0;
+    float hic15 = 0, hic36 = 0;
+    float peakAcc = 0;            // m/s²
+    float ridingVelocity = 0;
+    float headVelocity = 0;
+    // Peak linear acceleration per bin in 0.01 m/s², EVENT_LOG_SNAPSHOT_EMPTY
+    // where a bin holds no sample. Bin i covers
+    // [snapshotStartMs + i * snapshotBinUs / 1000, ...) relative to the trigger.
+    int16_t snapshotStartMs = 0;
+    uint16_t snapshotBinUs = 0;
+    uint8_t snapshotCount = 0;
+    uint16_t snapshot[EVENT_LOG_SNAPSHOT_BINS];
+};
+
+// Metrics plus a peak-preserving, down-sampled snapshot of the record
+ImpactRecord makeImpactRecord(const ImpactEvent& event, const ImpactReport& report);
+
+// Append-only impact log in a ring of flash pages.
+//
+// Every page starts with a header (magic, page sequence, erase count,
+// first record sequence, CRC) followed by CRC-framed records. Records are
+// only ever appended; when the newest page is full, the oldest page is
+// erased and becomes the newest, so all pages wear evenly. mount()
+// rebuilds the state from flash: a record torn by power loss fails its CRC
+// and is skipped, and a page whose header never got written is erased
+// again before use. Erasing a page stalls the CPU for tens of ms, so
+// prepare() lets the caller do it at a quiet moment rather than inside
+// append().
+class EventLog {
+public:
+    struct Stats {
+        uint32_t pages;
+        uint32_t usedPages;
+        uint32_t records;
+        uint32_t tornRecords;
+        uint32_t minEraseCount;
+        uint32_t maxEraseCount;
+        uint32_t bytesUsed;
+    };
+    
+    // Called with each valid frame, oldest first; return false to stop
+    typedef bool (*FrameVisitor)(const uint8_t* frame, size_t length, void* context);
+    
+    explicit EventLog(Flash& flash) : flash_(flash) {}
+    
+    bool mount();
+    bool format();
+    bool append(ImpactRecord& record);
+    // Start a fresh page now if the current one cannot take another record
+    bool prepare();
+    
+    size_t forEach(FrameVisitor visit, void* context);
+    Stats stats();
+    uint32_t nextSequence() const { return nextSequence_; }
+    
+    static size_t encode(const ImpactRecord& record, uint8_t* frame);
+    // Validates length, type and CRC
+    static bool decode(const uint8_t* frame, size_t length, ImpactRecord& record);
+    // Size of the frame starting with this 4-byte header, 0 if not a frame
+    static size_t frameSize(const uint8_t* header);
+    
+private:
+    struct PageHeader {
+        uint32_t magic;
+        uint32_t pageSequence;
+        uint32_t eraseCount;
+        uint32_t firstSequence;
+        uint32_t crc;
+    };
+    
+    uint32_t pageCount() const { return flash_.size() / flash_.pageSize(); }
+    bool readHeader(uint32_t page, PageHeader& header);
+    bool startPage(uint32_t page);
+    // Walks the frames of a page; returns the offset after the last frame
+    uint32_t scanPage(uint32_t page, FrameVisitor visit, void* context,
+                      uint32_t* valid, uint32_t* torn, uint32_t* lastSequence, bool* stopped);
+    
+    Flash& flash_;
+    bool mounted_ = false;
+    bool hasHead_ = false;
+    uint32_t headPage_ = 0;
+    uint32_t headPageSequence_ = 0;
+    uint32_t writeOffset_ = 0;
+    uint32_t nextSequence_ = 0;
+    uint32_t maxEraseCount_ = 0;
+};
+
+#endif
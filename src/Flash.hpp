@@ -0,0 +1,27 @@
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <cstdint>
+
+// A region of NOR flash, addressed from 0.
+//
+// Erasing a page sets it to 0xFF; programming can only clear bits, so a
+// location has to be erased before it is written again. program() takes
+// whole program units (4-byte words on the nRF52840) at aligned addresses.
+// Implementations: InternalFlash (nRF52840 NVMC via mbed FlashIAP) and, on
+// the host, FileFlash.
+class Flash {
+public:
+    virtual ~Flash() {}
+    
+    virtual uint32_t size() const = 0;
+    virtual uint32_t pageSize() const = 0;
+    virtual uint32_t programUnit() const = 0;
+    
+    virtual bool read(uint32_t address, void* data, uint32_t length) = 0;
+    virtual bool program(uint32_t address, const void* data, uint32_t length) = 0;
+    // Erase the page starting at address
+    virtual bool erase(uint32_t address) = 0;
+};
+
+#endif
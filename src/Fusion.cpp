@@ -0,0 +1,274 @@
+#include "Fusion.hpp"
+
+#include <cstring>
+
+#include "ImpactMetrics.hpp"
+
+namespace {
+
+// Only trust the accelerometer as a gravity reference close to 1 g.
+// Compared on the squared norm, so no square root is needed.
+bool accelUsable(Scalar normSquared) {
+    const Scalar lo = S(G_CONSTANT) - S(FUSION_ACCEL_GATE);
+    const Scalar hi = S(G_CONSTANT) + S(FUSION_ACCEL_GATE);
+    return normSquared > lo * lo && normSquared < hi * hi;
+}
+
+Quaternion estimateOrientationFromAccel(Scalar ax, Scalar ay, Scalar az) {
+    // Normalize acceleration vector
+    Scalar norm = std::sqrt(ax*ax + ay*ay + az*az);
+    
+    // Only use accelerometer if the magnitude is close to 1g
+    if (std::fabs(norm - S(G_CONSTANT)) > S(0.5)) {
+        return Quaternion(); // Return identity quaternion if acceleration is not reliable
+    }
+    
+    ax /= norm;
+    ay /= norm;
+    az /= norm;
+    
+    // Calculate roll and pitch from accelerometer
+    Scalar roll = std::atan2(ay, az);
+    Scalar pitch = std::atan2(-ax, std::sqrt(ay*ay + az*az));
+    
+    // Convert to quaternion
+    Scalar cy = std::cos(pitch * S(0.5));
+    Scalar sy = std::sin(pitch * S(0.5));
+    Scalar cr = std::cos(roll * S(0.5));
+    Scalar sr = std::sin(roll * S(0.5));
+    
+    return Quaternion(
+        cy * cr,  // w
+        cy * sr,  // x
+        sy * cr,  // y
+        sy * sr   // z
+    );
+}
+
+void complementaryUpdate(FusionState& state, Scalar gx, Scalar gy, Scalar gz,
+                         Scalar ax, Scalar ay, Scalar az, Scalar dt) {
+    Quaternion& orientation = state.q;
+    
+    // Gyroscope-based orientation update
+    Quaternion qDot(
+        S(-0.5) * (gx * orientation.x + gy * orientation.y + gz * orientation.z),
+        S(0.5) * (gx * orientation.w + gz * orientation.y - gy * orientation.z),
+        S(0.5) * (gy * orientation.w - gz * orientation.x + gx * orientation.z),
+        S(0.5) * (gz * orientation.w + gy * orientation.x - gx * orientation.y)
+    );
+    
+    // Update orientation quaternion using the derivative
+    Quaternion qGyro;
+    qGyro.w = orientation.w + qDot.w * dt;
+    qGyro.x = orientation.x + qDot.x * dt;
+    qGyro.y = orientation.y + qDot.y * dt;
+    qGyro.z = orientation.z + qDot.z * dt;
+    qGyro.normalize();
+    
+    // Get accelerometer-based orientation
+    Quaternion qAccel = estimateOrientationFromAccel(ax, ay, az);
+    
+    // Complementary filter
+    // Use higher weight for gyroscope when there's significant motion
+    Scalar alpha = S(0.96);  // Gyroscope weight
+    Scalar accelMagnitude = std::sqrt(ax * ax + ay * ay + az * az);
+    
+    // Reduce gyroscope weight when acceleration is close to 1g
+    if (std::fabs(accelMagnitude - S(G_CONSTANT)) < S(0.5)) {
+        alpha = S(0.8);  // Give more weight to accelerometer when stable
+    }
+    
+    // Combine gyroscope and accelerometer data
+    orientation.w = alpha * qGyro.w + (1 - alpha) * qAccel.w;
+    orientation.x = alpha * qGyro.x + (1 - alpha) * qAccel.x;
+    orientation.y = alpha * qGyro.y + (1 - alpha) * qAccel.y;
+    orientation.z = alpha * qGyro.z + (1 - alpha) * qAccel.z;
+    
+    // Normalize to prevent drift
+    orientation.normalize();
+}
+
+// Madgwick's IMU update: gyro rate plus one normalized gradient-descent
+// step towards the measured gravity direction
+void madgwickUpdate(FusionState& state, Scalar gx, Scalar gy, Scalar gz,
+                    Scalar ax, Scalar ay, Scalar az, Scalar dt) {
+    Scalar q0 = state.q.w, q1 = state.q.x, q2 = state.q.y, q3 = state.q.z;
+    
+    // Rate of change of quaternion from gyroscope
+    Scalar qDot0 = S(0.5) * (-q1 * gx - q2 * gy - q3 * gz);
+    Scalar qDot1 = S(0.5) * (q0 * gx + q2 * gz - q3 * gy);
+    Scalar qDot2 = S(0.5) * (q0 * gy - q1 * gz + q3 * gx);
+    Scalar qDot3 = S(0.5) * (q0 * gz + q1 * gy - q2 * gx);
+    
+    Scalar accNormSquared = ax * ax + ay * ay + az * az;
+    if (accelUsable(accNormSquared)) {
+        Scalar recipNorm = invSqrt(accNormSquared);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+        
+        Scalar _2q0 = 2 * q0, _2q1 = 2 * q1, _2q2 = 2 * q2, _2q3 = 2 * q3;
+        Scalar _4q0 = 4 * q0, _4q1 = 4 * q1, _4q2 = 4 * q2;
+        Scalar _8q1 = 8 * q1, _8q2 = 8 * q2;
+        Scalar q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        
+        // Gradient of the gravity-direction objective
+        Scalar s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        Scalar s1 = _4q1 * q3q3 - _2q3 * ax + 4 * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        Scalar s2 = 4 * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        Scalar s3 = 4 * q1q1 * q3 - _2q1 * ax + 4 * q2q2 * q3 - _2q2 * ay;
+        
+        Scalar stepNormSquared = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (stepNormSquared > 0) {
+            Scalar step = S(MADGWICK_BETA) * invSqrt(stepNormSquared);
+            qDot0 -= step * s0;
+            qDot1 -= step * s1;
+            qDot2 -= step * s2;
+            qDot3 -= step * s3;
+        }
+    }
+    
+    q0 += qDot0 * dt;
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    
+    Scalar recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    state.q = Quaternion(q0 * recipNorm, q1 * recipNorm, q2 * recipNorm, q3 * recipNorm);
+}
+
+// Mahony's IMU update: proportional-integral feedback of the cross product
+// between measured and estimated gravity, applied to the gyro rate
+void mahonyUpdate(FusionState& state, Scalar gx, Scalar gy, Scalar gz,
+                  Scalar ax, Scalar ay, Scalar az, Scalar dt) {
+    Scalar q0 = state.q.w, q1 = state.q.x, q2 = state.q.y, q3 = state.q.z;
+    
+    Scalar accNormSquared = ax * ax + ay * ay + az * az;
+    if (accelUsable(accNormSquared)) {
+        Scalar recipNorm = invSqrt(accNormSquared);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+        
+        // Estimated gravity direction, halved
+        Scalar halfvx = q1 * q3 - q0 * q2;
+        Scalar halfvy = q0 * q1 + q2 * q3;
+        Scalar halfvz = q0 * q0 - S(0.5) + q3 * q3;
+        
+        // Error is the cross product between measured and estimated direction
+        Scalar halfex = ay * halfvz - az * halfvy;
+        Scalar halfey = az * halfvx - ax * halfvz;
+        Scalar halfez = ax * halfvy - ay * halfvx;
+        
+        if (S(MAHONY_KI) > 0) {
+            state.integralX += 2 * S(MAHONY_KI) * halfex * dt;
+            state.integralY += 2 * S(MAHONY_KI) * halfey * dt;
+            state.integralZ += 2 * S(MAHONY_KI) * halfez * dt;
+            gx += state.integralX;
+            gy += state.integralY;
+            gz += state.integralZ;
+        }
+        
+        gx += 2 * S(MAHONY_KP) * halfex;
+        gy += 2 * S(MAHONY_KP) * halfey;
+        gz += 2 * S(MAHONY_KP) * halfez;
+    }
+    
+    // Integrate rate of change of quaternion
+    gx *= S(0.5) * dt;
+    gy *= S(0.5) * dt;
+    gz *= S(0.5) * dt;
+    Scalar qa = q0, qb = q1, qc = q2;
+    q0 += -qb * gx - qc * gy - q3 * gz;
+    q1 += qa * gx + qc * gz - q3 * gy;
+    q2 += qa * gy - qb * gz + q3 * gx;
+    q3 += qa * gz + qb * gy - qc * gx;
+    
+    Scalar recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    state.q = Quaternion(q0 * recipNorm, q1 * recipNorm, q2 * recipNorm, q3 * recipNorm);
+}
+
+} // namespace
+
+float invSqrt(float x) {
+    float half = 0.5f * x;
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f3759df - (bits >> 1);
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    return y;
+}
+
+double invSqrt(double x) {
+    return 1.0 / std::sqrt(x);
+}
+
+void fusionUpdate(FusionAlgorithm algorithm, FusionState& state,
+                  Scalar gx, Scalar gy, Scalar gz,
+                  Scalar ax, Scalar ay, Scalar az, Scalar dt) {
+    switch (algorithm) {
+        case FusionAlgorithm::MADGWICK:
+            madgwickUpdate(state, gx, gy, gz, ax, ay, az, dt);
+            break;
+        case FusionAlgorithm::MAHONY:
+            mahonyUpdate(state, gx, gy, gz, ax, ay, az, dt);
+            break;
+        case FusionAlgorithm::COMPLEMENTARY:
+        default:
+            complementaryUpdate(state, gx, gy, gz, ax, ay, az, dt);
+            break;
+    }
+}
+
+void fusionGravity(FusionAlgorithm algorithm, const FusionState& state,
+                   Scalar& gx, Scalar& gy, Scalar& gz) {
+    const Quaternion& q = state.q;
+    if (algorithm == FusionAlgorithm::COMPLEMENTARY) {
+        // Third column of R(q), i.e. R·(0,0,1), as the original filter used
+        gx = 2*q.x*q.z + 2*q.w*q.y;
+        gy = 2*q.y*q.z - 2*q.w*q.x;
+        gz = 1 - 2*q.x*q.x - 2*q.y*q.y;
+        return;
+    }
+    
+    // World up seen from the sensor: third row of R(q), i.e. Rᵀ·(0,0,1)
+    gx = 2 * (q.x * q.z - q.w * q.y);
+    gy = 2 * (q.w * q.x + q.y * q.z);
+    gz = 1 - 2 * (q.x * q.x + q.y * q.y);
+}
+
+void fusionAlign(FusionAlgorithm algorithm, FusionState& state,
+                 Scalar ax, Scalar ay, Scalar az) {
+    const Scalar norm = std::sqrt(ax * ax + ay * ay + az * az);
+    if (norm == 0) return;
+    ax /= norm;
+    ay /= norm;
+    az /= norm;
+    
+    state.reset();
+    if (1 + az < S(1e-6)) {
+        // Upside down: half a turn about x
+        state.q = Quaternion(0, 1, 0, 0);
+        return;
+    }
+    // Shortest rotation between the gravity direction and z; the
+    // complementary filter reads the rotation matrix the other way round
+    if (algorithm == FusionAlgorithm::COMPLEMENTARY) {
+        state.q = Quaternion(1 + az, -ay, ax, 0);
+    } else {
+        state.q = Quaternion(1 + az, ay, -ax, 0);
+    }
+    state.q.normalize();
+}
+
+const char* fusionName(FusionAlgorithm algorithm) {
+    switch (algorithm) {
+        case FusionAlgorithm::MADGWICK: return "madgwick";
+        case FusionAlgorithm::MAHONY: return "mahony";
+        case FusionAlgorithm::COMPLEMENTARY:
+        default: return "complementary";
+    }
+}
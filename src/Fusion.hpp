@@ -0,0 +1,62 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include <cstdint>
+#include "Quaternion.hpp"
+#include "Scalar.hpp"
+
+// Madgwick gradient-descent gain (rad/s)
+#define MADGWICK_BETA 0.1
+// Mahony proportional and integral gains
+#define MAHONY_KP 0.5
+#define MAHONY_KI 0.0
+// Accelerometer corrections are skipped while |acc| is further than this
+// from 1 g (m/s²), so impacts and hard braking do not tilt the estimate
+#define FUSION_ACCEL_GATE 2.0
+
+// Attitude filters. COMPLEMENTARY is the original roll/pitch blend, kept
+// for comparison; MADGWICK and MAHONY are trig-free quaternion filters.
+enum class FusionAlgorithm : uint8_t {
+    COMPLEMENTARY,
+    MADGWICK,
+    MAHONY
+};
+
+// Filter state. The quaternion rotates the sensor frame into the world
+// frame (q̇ = ½ q ⊗ ω); the integral term is only used by Mahony.
+struct FusionState {
+    Quaternion q;
+    Scalar integralX = 0, integralY = 0, integralZ = 0;
+    
+    void reset() {
+        q = Quaternion();
+        integralX = integralY = integralZ = 0;
+    }
+};
+
+// 1/sqrt(x): bit-level estimate plus two Newton steps for float (relative
+// error around 5e-6), plain 1/sqrt for double
+float invSqrt(float x);
+double invSqrt(double x);
+
+// Advance the state by one sample. Gyro in rad/s, acc in m/s² with bias
+// already removed, dt in seconds.
+void fusionUpdate(FusionAlgorithm algorithm, FusionState& state,
+                  Scalar gx, Scalar gy, Scalar gz,
+                  Scalar ax, Scalar ay, Scalar az, Scalar dt);
+
+// Set the attitude in which gravity points along acc (m/s², any length);
+// heading is left at zero. Starts a filter without waiting for it to
+// converge from level.
+void fusionAlign(FusionAlgorithm algorithm, FusionState& state,
+                 Scalar ax, Scalar ay, Scalar az);
+
+// Unit gravity direction in the sensor frame for the current state. Only
+// the one rotation-matrix column that is needed gets computed.
+void fusionGravity(FusionAlgorithm algorithm, const FusionState& state,
+                   Scalar& gx, Scalar& gy, Scalar& gz);
+
+// Name for logs and benchmarks
+const char* fusionName(FusionAlgorithm algorithm);
+
+#endif
@@ -1,329 +1,270 @@
 #include "IMUProcessor.hpp"
 
-IMUProcessor* IMUProcessor::instance = nullptr;
+#include "Kernels.hpp"
+#include "Profiler.hpp"
 
-void IMUProcessor::clearData() {
+// Out-of-line definitions of the static constexpr members (C++14): std::min
+// takes them by reference, which needs storage once the optimizer does not
+// fold them
+constexpr size_t IMUProcessor::MAX_BUFFER_SIZE;
+constexpr size_t IMUProcessor::PROCESS_CHUNK_SIZE;
+
+void IMUProcessor::restart() {
     imuDataBuffer.clear();
-    impactDetected = false;
+    velocityHistory.clear();
     lastImpactTime = 0;
-    biasCalculated = false;
-    orientation = Quaternion(); // Reset orientation
-    biasAccX = biasAccY = biasAccZ = 0.0f;
-    biasGyroX = biasGyroY = biasGyroZ = 0.0f;
+    sampleGaps = 0;
+    activityPeak = ActivityPeak();
+    eventCapture.reset();
+    biasEstimator.interrupt();
+    attitudeAligned = false;
+    fusion.reset(); // Reset orientation
+}
+
+void IMUProcessor::clearData() {
+    restart();
+    biasEstimator.reset();
+    biasAccX = biasAccY = biasAccZ = 0;
+    biasGyroX = biasGyroY = biasGyroZ = 0;
+}
+
+ActivityPeak IMUProcessor::takeActivityPeak() {
+    const ActivityPeak peak = activityPeak;
+    activityPeak = ActivityPeak();
+    return peak;
+}
+
+void IMUProcessor::setCalibration(const SensorCalibration& calibration) {
+    biasEstimator.set(calibration);
+    applyBias();
+}
+
+bool IMUProcessor::getCalibration(SensorCalibration& calibration) const {
+    if (!biasEstimator.valid()) return false;
+    calibration = biasEstimator.calibration();
+    return true;
+}
+
+void IMUProcessor::applyBias() {
+    const SensorCalibration calibration = biasEstimator.calibration();
+    biasAccX = calibration.accBias[0];
+    biasAccY = calibration.accBias[1];
+    biasAccZ = calibration.accBias[2];
+    biasGyroX = calibration.gyroBias[0];
+    biasGyroY = calibration.gyroBias[1];
+    biasGyroZ = calibration.gyroBias[2];
 }
 
 
 void IMUProcessor::processData(float accX, float accY, float accZ, 
                              float gyroX, float gyroY, float gyroZ,
                              uint32_t timestamp) {
-    IMUData data;
-    data.timestamp = timestamp;
-    data.accX = accX;
-    data.accY = accY;
-    data.accZ = accZ;
-    data.gyroX = gyroX;
-    data.gyroY = gyroY;
-    data.gyroZ = gyroZ;
-    
-    // Calculate time delta
-    float dt = 0.0f;
-    if (!imuDataBuffer.empty()) {
-        dt = (timestamp - imuDataBuffer.back().timestamp) / 1000.0f; // Convert to seconds
+    const float acc[3] = {accX, accY, accZ};
+    const float gyro[3] = {gyroX, gyroY, gyroZ};
+    processBatch(acc, gyro, &timestamp, 1);
+}
+
+void IMUProcessor::processBatch(const float* acc, const float* gyro,
+                                const uint32_t* timestamps, size_t count) {
+    PROFILE_SCOPE(PROCESS);
+    size_t i = 0;
+    while (i < count) {
+        size_t n = std::min(count - i, PROCESS_CHUNK_SIZE);
+        processChunk(acc + 3 * i, gyro + 3 * i, timestamps + i, n);
+        i += n;
+    }
+}
+
+void IMUProcessor::processChunk(const float* acc, const float* gyro,
+                                const uint32_t* timestamps, size_t n) {
+    Scalar ax[PROCESS_CHUNK_SIZE], ay[PROCESS_CHUNK_SIZE], az[PROCESS_CHUNK_SIZE];
+    Scalar wx[PROCESS_CHUNK_SIZE], wy[PROCESS_CHUNK_SIZE], wz[PROCESS_CHUNK_SIZE];
+    Scalar gx[PROCESS_CHUNK_SIZE], gy[PROCESS_CHUNK_SIZE], gz[PROCESS_CHUNK_SIZE];
+    Scalar dt[PROCESS_CHUNK_SIZE];
+    IMUData data[PROCESS_CHUNK_SIZE];
+    
+    // Previous sample is carried through instead of re-read from the buffer
+    const bool hasPrev = !imuDataBuffer.empty();
+    IMUData prev;
+    if (hasPrev) {
+        prev = imuDataBuffer.back();
     }
     
-    // Update orientation using gyroscope data
-    updateOrientation(data, dt);
-    
-    // Get gravity vector in sensor frame
-    float gx = 0.0f, gy = 0.0f, gz = G_CONSTANT;
-    rotateGravity(orientation, gx, gy, gz);
-    
-    // Calculate velocity components using trapezoidal integration
-    if (!imuDataBuffer.empty()) {
-        const IMUData& prev = imuDataBuffer.back();
+    // Sequential stage: attitude and gravity for each sample
+    uint32_t prevTimestamp = prev.timestamp;
+    bool biasChanged = false;
+    for (size_t k = 0; k < n; ++k) {
+        IMUData& d = data[k];
+        d.timestamp = timestamps[k];
+        d.accX = acc[3 * k];
+        d.accY = acc[3 * k + 1];
+        d.accZ = acc[3 * k + 2];
+        d.gyroX = gyro[3 * k];
+        d.gyroY = gyro[3 * k + 1];
+        d.gyroZ = gyro[3 * k + 2];
         
-        // Calculate acceleration components for both current and previous sample
-        float currAccX = data.accX - biasAccX - gx;
-        float currAccY = data.accY - biasAccY - gy;
-        float currAccZ = data.accZ - biasAccZ - gz;
+        // Calculate time delta
+        dt[k] = (hasPrev || k > 0) ? (d.timestamp - prevTimestamp) / S(1000000) : S(0); // Convert to seconds
+        // Across a gap the motion is unknown: hold attitude and velocity
+        if ((hasPrev || k > 0) && d.timestamp - prevTimestamp > SAMPLE_GAP_MS * 1000u) {
+            dt[k] = S(0);
+            sampleGaps++;
+        }
+        prevTimestamp = d.timestamp;
         
-        float prevAccX = prev.accX - biasAccX - gx;
-        float prevAccY = prev.accY - biasAccY - gy;
-        float prevAccZ = prev.accZ - biasAccZ - gz;
+        // The first sample sets the attitude from gravity, so a tilted
+        // sensor is right from the start
+        if (!attitudeAligned) {
+            fusionAlign(fusionAlgorithm, fusion, d.accX, d.accY, d.accZ);
+            attitudeAligned = true;
+        }
         
-        // Trapezoidal integration
-        data.velX = prev.velX + (currAccX + prevAccX) * dt / 2.0f;
-        data.velY = prev.velY + (currAccY + prevAccY) * dt / 2.0f;
-        data.velZ = prev.velZ + (currAccZ + prevAccZ) * dt / 2.0f;
-    } else {
-        data.velX = data.velY = data.velZ = 0.0f;
-    }
-    
-    // Update bias if not calculated yet
-    if (!biasCalculated) {
-        updateBias(data);
+        // Update orientation using gyroscope data
+        updateOrientation(d, dt[k]);
+        
+        // Refine the bias while the sensor lies still; it takes effect
+        // from the next chunk
+        const Scalar rawAcc[3] = {d.accX, d.accY, d.accZ};
+        const Scalar rawGyro[3] = {d.gyroX, d.gyroY, d.gyroZ};
+        biasChanged |= biasEstimator.update(rawAcc, rawGyro, d.timestamp);
+        
+        // Gravity in the sensor frame at this sample's attitude
+        fusionGravity(fusionAlgorithm, fusion, gx[k], gy[k], gz[k]);
+        gx[k] *= S(G_CONSTANT);
+        gy[k] *= S(G_CONSTANT);
+        gz[k] *= S(G_CONSTANT);
     }
     
-    // Add to buffer
-    imuDataBuffer.push_back(data);
-    if (imuDataBuffer.size() > MAX_BUFFER_SIZE) {
-        imuDataBuffer.pop_front();
-    }
-
-    // Check for impact
-    if (biasCalculated) {
-        double linearAcc = calculateLinearAcceleration(data);
-        if (linearAcc > IMPACT_THRESHOLD_LOW && 
-            (timestamp - lastImpactTime) > IMPACT_COOLDOWN) {
-            impactDetected = true;
-            lastImpactTime = timestamp;
+    // Batch stage: bias and gravity removal, magnitudes, integration
+    kernels::deinterleave3(acc, ax, ay, az, n);
+    kernels::deinterleave3(gyro, wx, wy, wz, n);
+    kernels::offset(ax, -biasAccX, ax, n);
+    kernels::offset(ay, -biasAccY, ay, n);
+    kernels::offset(az, -biasAccZ, az, n);
+    kernels::offset(wx, -biasGyroX, wx, n);
+    kernels::offset(wy, -biasGyroY, wy, n);
+    kernels::offset(wz, -biasGyroZ, wz, n);
+    
+    Scalar linX[PROCESS_CHUNK_SIZE], linY[PROCESS_CHUNK_SIZE], linZ[PROCESS_CHUNK_SIZE];
+    Scalar linMag[PROCESS_CHUNK_SIZE], gyroMag[PROCESS_CHUNK_SIZE];
+    kernels::subtract(ax, gx, linX, n);
+    kernels::subtract(ay, gy, linY, n);
+    kernels::subtract(az, gz, linZ, n);
+    kernels::magnitude3(linX, linY, linZ, linMag, n);
+    kernels::magnitude3(wx, wy, wz, gyroMag, n);
+    
+    // Trapezoidal integration; the first sample starts from rest
+    Scalar velX[PROCESS_CHUNK_SIZE], velY[PROCESS_CHUNK_SIZE], velZ[PROCESS_CHUNK_SIZE];
+    kernels::trapezoid(linX, dt, hasPrev ? prev.linAccX : linX[0], hasPrev ? prev.velX : 0, velX, n);
+    kernels::trapezoid(linY, dt, hasPrev ? prev.linAccY : linY[0], hasPrev ? prev.velY : 0, velY, n);
+    kernels::trapezoid(linZ, dt, hasPrev ? prev.linAccZ : linZ[0], hasPrev ? prev.velZ : 0, velZ, n);
+    Scalar speed[PROCESS_CHUNK_SIZE];
+    kernels::magnitude3(velX, velY, velZ, speed, n);
+    
+    for (size_t k = 0; k < n; ++k) {
+        IMUData& d = data[k];
+        d.linAccX = linX[k];
+        d.linAccY = linY[k];
+        d.linAccZ = linZ[k];
+        d.linAcc = linMag[k];
+        d.gyroMag = gyroMag[k];
+        d.velX = velX[k];
+        d.velY = velY[k];
+        d.velZ = velZ[k];
+        activityPeak.linAcc = std::max(activityPeak.linAcc, d.linAcc);
+        activityPeak.gyroMag = std::max(activityPeak.gyroMag, d.gyroMag);
+        
+        // Add to buffer, overwriting the oldest sample once full
+        imuDataBuffer.push(d);
+        velocityHistory.add(d.timestamp, speed[k]);
+        if (eventCapture.filling()) {
+            eventCapture.append(d);
+        }
+        
+        // Check for impact
+        if (d.linAcc > S(IMPACT_THRESHOLD_LOW) &&
+            (d.timestamp - lastImpactTime) > IMPACT_COOLDOWN * 1000u) {
+            lastImpactTime = d.timestamp;
+            eventCapture.trigger(imuDataBuffer, velocityHistory, d.timestamp);
         }
     }
-}
-
-Quaternion IMUProcessor::estimateOrientationFromAccel(const IMUData& data) {
-    // Normalize acceleration vector
-    float ax = data.accX - biasAccX;
-    float ay = data.accY - biasAccY;
-    float az = data.accZ - biasAccZ;
-    float norm = sqrt(ax*ax + ay*ay + az*az);
-    
-    // Only use accelerometer if the magnitude is close to 1g
-    if (abs(norm - G_CONSTANT) > 0.5) {
-        return Quaternion(); // Return identity quaternion if acceleration is not reliable
-    }
-    
-    ax /= norm;
-    ay /= norm;
-    az /= norm;
-    
-    // Calculate roll and pitch from accelerometer
-    float roll = atan2(ay, az);
-    float pitch = atan2(-ax, sqrt(ay*ay + az*az));
-    
-    // Convert to quaternion
-    float cy = cos(pitch * 0.5);
-    float sy = sin(pitch * 0.5);
-    float cr = cos(roll * 0.5);
-    float sr = sin(roll * 0.5);
-    
-    return Quaternion(
-        cy * cr,  // w
-        cy * sr,  // x
-        sy * cr,  // y
-        sy * sr   // z
-    );
-}
-
-void IMUProcessor::updateOrientation(const IMUData& data, float dt) {
-    // Gyroscope-based orientation update
-    Quaternion qDot(
-        -0.5 * (data.gyroX * orientation.x + data.gyroY * orientation.y + data.gyroZ * orientation.z),
-        0.5 * (data.gyroX * orientation.w + data.gyroZ * orientation.y - data.gyroY * orientation.z),
-        0.5 * (data.gyroY * orientation.w - data.gyroZ * orientation.x + data.gyroX * orientation.z),
-        0.5 * (data.gyroZ * orientation.w + data.gyroY * orientation.x - data.gyroX * orientation.y)
-    );
-    
-    // Update orientation quaternion using the derivative
-    Quaternion qGyro;
-    qGyro.w = orientation.w + qDot.w * dt;
-    qGyro.x = orientation.x + qDot.x * dt;
-    qGyro.y = orientation.y + qDot.y * dt;
-    qGyro.z = orientation.z + qDot.z * dt;
-    qGyro.normalize();
-    
-    // Get accelerometer-based orientation
-    Quaternion qAccel = estimateOrientationFromAccel(data);
-    
-    // Complementary filter
-    // Use higher weight for gyroscope when there's significant motion
-    float alpha = 0.96f;  // Gyroscope weight
-    float accelMagnitude = sqrt(
-        (data.accX - biasAccX) * (data.accX - biasAccX) +
-        (data.accY - biasAccY) * (data.accY - biasAccY) +
-        (data.accZ - biasAccZ) * (data.accZ - biasAccZ)
-    );
     
-    // Reduce gyroscope weight when acceleration is close to 1g
-    if (abs(accelMagnitude - G_CONSTANT) < 0.5) {
-        alpha = 0.8f;  // Give more weight to accelerometer when stable
+    if (biasChanged) {
+        applyBias();
     }
-    
-    // Combine gyroscope and accelerometer data
-    orientation.w = alpha * qGyro.w + (1 - alpha) * qAccel.w;
-    orientation.x = alpha * qGyro.x + (1 - alpha) * qAccel.x;
-    orientation.y = alpha * qGyro.y + (1 - alpha) * qAccel.y;
-    orientation.z = alpha * qGyro.z + (1 - alpha) * qAccel.z;
-    
-    // Normalize to prevent drift
-    orientation.normalize();
-}
-
-void IMUProcessor::rotateGravity(const Quaternion& q, float& gx, float& gy, float& gz) {
-    // Rotate gravity vector using quaternion
-    float gx_orig = gx, gy_orig = gy, gz_orig = gz;
-    
-    gx = (1 - 2*q.y*q.y - 2*q.z*q.z) * gx_orig +
-         (2*q.x*q.y - 2*q.w*q.z) * gy_orig +
-         (2*q.x*q.z + 2*q.w*q.y) * gz_orig;
-         
-    gy = (2*q.x*q.y + 2*q.w*q.z) * gx_orig +
-         (1 - 2*q.x*q.x - 2*q.z*q.z) * gy_orig +
-         (2*q.y*q.z - 2*q.w*q.x) * gz_orig;
-         
-    gz = (2*q.x*q.z - 2*q.w*q.y) * gx_orig +
-         (2*q.y*q.z + 2*q.w*q.x) * gy_orig +
-         (1 - 2*q.x*q.x - 2*q.y*q.y) * gz_orig;
 }
 
-void IMUProcessor::updateBias(const IMUData& data) {
-    static int sampleCount = 0;
-    
-    biasAccX += data.accX;
-    biasAccY += data.accY;
-    biasAccZ += data.accZ;
-    biasGyroX += data.gyroX;
-    biasGyroY += data.gyroY;
-    biasGyroZ += data.gyroZ;
-    
-    sampleCount++;
-    
-    if (sampleCount >= BIAS_CALIBRATION_SAMPLES) {
-        biasAccX /= BIAS_CALIBRATION_SAMPLES;
-        biasAccY /= BIAS_CALIBRATION_SAMPLES;
-        biasAccZ /= BIAS_CALIBRATION_SAMPLES;
-        biasGyroX /= BIAS_CALIBRATION_SAMPLES;
-        biasGyroY /= BIAS_CALIBRATION_SAMPLES;
-        biasGyroZ /= BIAS_CALIBRATION_SAMPLES;
-        
-        // Adjust Z bias to account for gravity
-        biasAccZ -= G_CONSTANT;
-        
-        biasCalculated = true;
+void IMUProcessor::updateOrientation(const IMUData& data, Scalar dt) {
+    PROFILE_SCOPE(ORIENTATION);
+    if (fusionAlgorithm == FusionAlgorithm::COMPLEMENTARY) {
+        // Inputs exactly as the original filter consumed them
+        fusionUpdate(fusionAlgorithm, fusion,
+                     data.gyroX, data.gyroY, data.gyroZ,
+                     data.accX - biasAccX, data.accY - biasAccY, data.accZ - biasAccZ, dt);
+        return;
     }
-}
-
-double IMUProcessor::calculateLinearAcceleration(const IMUData& data) {
-    // Calculate linear acceleration by removing gravity and bias
-    float ax = data.accX - biasAccX;
-    float ay = data.accY - biasAccY;
-    float az = data.accZ - biasAccZ;
-    
-    // Get gravity vector in sensor frame
-    float gx = 0.0f, gy = 0.0f, gz = G_CONSTANT;
-    rotateGravity(orientation, gx, gy, gz);
     
-    // Remove gravity
-    ax -= gx;
-    ay -= gy;
-    az -= gz;
-    
-    return sqrt(ax*ax + ay*ay + az*az);
-}
-
-double IMUProcessor::calculateAngularVelocity(const IMUData& data) {
-    float wx = data.gyroX - biasGyroX;
-    float wy = data.gyroY - biasGyroY;
-    float wz = data.gyroZ - biasGyroZ;
-    return sqrt(wx*wx + wy*wy + wz*wz);
+    fusionUpdate(fusionAlgorithm, fusion,
+                 data.gyroX - biasGyroX, data.gyroY - biasGyroY, data.gyroZ - biasGyroZ,
+                 data.accX - biasAccX, data.accY - biasAccY, data.accZ - biasAccZ, dt);
 }
 
-double IMUProcessor::calculateVelocity(const IMUData& data) {
-    return sqrt(data.velX*data.velX + data.velY*data.velY + data.velZ*data.velZ);
+int IMUProcessor::impactLevel(Scalar linearAcc) {
+    if (linearAcc >= S(IMPACT_THRESHOLD_SEVERE)) return 4;
+    if (linearAcc >= S(IMPACT_THRESHOLD_HIGH)) return 3;
+    if (linearAcc >= S(IMPACT_THRESHOLD_MEDIUM)) return 2;
+    if (linearAcc >= S(IMPACT_THRESHOLD_LOW)) return 1;
+    return 0;
 }
 
-std::vector<IMUData> IMUProcessor::getImpactWindow(uint32_t impactTime, double window_ms) {
-    std::vector<IMUData> window;
-    uint32_t startTime = impactTime - static_cast<uint32_t>(window_ms);
-    
-    for (const auto& data : imuDataBuffer) {
-        if (data.timestamp >= startTime && data.timestamp <= impactTime) {
-            window.push_back(data);
-        }
+int IMUProcessor::getImpactLevel() {
+    const ImpactEvent* event = eventCapture.ready();
+    if (!event) return 0;
+    
+    // Peak from the trigger to the end of the record
+    SampleWindow window = event->postTrigger();
+    Scalar linearAcc = 0;
+    for (size_t i = window.begin; i < window.end; ++i) {
+        linearAcc = std::max(linearAcc, event->samples.linAcc(i));
     }
-    
-    return window;
+    return impactLevel(linearAcc);
 }
 
-int IMUProcessor::getImpactLevel() {
-    if (imuDataBuffer.empty()) return 0;
-    
-    double linearAcc = calculateLinearAcceleration(imuDataBuffer.back());
+// HIC is searched from the trigger (the first sample over the threshold)
+// to the end of the record; computeHIC finds the worst interval inside it
+Scalar IMUProcessor::getHIC(Scalar window_ms) {
+    const ImpactEvent* event = eventCapture.ready();
+    if (!event || event->samples.empty()) return 0;
     
-    if (linearAcc >= IMPACT_THRESHOLD_SEVERE) return 4;
-    if (linearAcc >= IMPACT_THRESHOLD_HIGH) return 3;
-    if (linearAcc >= IMPACT_THRESHOLD_MEDIUM) return 2;
-    if (linearAcc >= IMPACT_THRESHOLD_LOW) return 1;
-    return 0;
+    return computeHIC(event->samples, event->postTrigger(), window_ms, window_ms).hic15;
 }
 
-double IMUProcessor::getHIC(double window_ms) {
-    if (imuDataBuffer.empty()) return 0.0;
-    
-    auto window = getImpactWindow(imuDataBuffer.back().timestamp, window_ms);
-    if (window.empty()) return 0.0;
+HICResult IMUProcessor::getHIC15And36() {
+    const ImpactEvent* event = eventCapture.ready();
+    if (!event || event->samples.empty()) return HICResult();
     
-    double maxHIC = 0.0;
-    double window_s = window_ms / 1000.0;  // Convert to seconds
-    
-    for (size_t i = 0; i < window.size(); ++i) {
-        for (size_t j = i + 1; j < window.size(); ++j) {
-            double dt = (window[j].timestamp - window[i].timestamp) / 1000.0;  // Convert to seconds
-            if (dt > window_s) break;
-            
-            // Calculate average acceleration over the interval
-            double sumAcc = 0.0;
-            for (size_t k = i; k <= j; ++k) {
-                // Convert linear acceleration to g's
-                sumAcc += calculateLinearAcceleration(window[k]) / G_CONSTANT;
-            }
-            double avgAcc = sumAcc / (j - i + 1);
-            
-            // Calculate HIC using the standard formula
-            double hic = dt * pow(avgAcc, 2.5);
-            maxHIC = std::max(maxHIC, hic);
-        }
-    }
-    
-    return maxHIC;
+    return computeHIC(event->samples, event->postTrigger(), S(HIC15_WINDOW_MS), S(HIC36_WINDOW_MS));
 }
 
-double IMUProcessor::getAccOnImpact() {
-    if (imuDataBuffer.empty()) return 0.0;
-    if (!impactDetected) return 0.0;
+Scalar IMUProcessor::getAccOnImpact() {
+    const ImpactEvent* event = eventCapture.ready();
+    if (!event || event->samples.empty()) return 0;
     
-    for (const auto& data : imuDataBuffer) {
-        if (data.timestamp == lastImpactTime) {
-            return calculateLinearAcceleration(data);
-        }
-    }
-    return 0.0;
+    return event->samples.linAcc(event->triggerIndex);
 }
 
-double IMUProcessor::getRidingVelocitybeforeImpact() {
-    if (imuDataBuffer.empty()) return 0.0;
-    
-    // Get average velocity magnitude of 5s to 1s before impact
-    std::vector<IMUData> velocityWindow = getImpactWindow(lastImpactTime - 5000, 4000);
-    if (velocityWindow.empty()) return 0.0;
+Scalar IMUProcessor::getRidingVelocitybeforeImpact() {
+    const ImpactEvent* event = eventCapture.ready();
+    if (!event) return 0;
     
-    double sumVelocity = 0.0;
-    for (const auto& data : velocityWindow) {
-        sumVelocity += calculateVelocity(data);
-    }
-    return sumVelocity / velocityWindow.size();
+    // Average speed 9 s to 5 s before the impact
+    return event->ridingVelocity();
 }
 
-double IMUProcessor::getHeadVelocityOnImpact() {
-    if (imuDataBuffer.empty()) return 0.0;
+Scalar IMUProcessor::getHeadVelocityOnImpact() {
+    const ImpactEvent* event = eventCapture.ready();
+    if (!event) return 0;
     
     // Get average velocity of 100ms before impact
-    std::vector<IMUData> velocityWindow = getImpactWindow(lastImpactTime - 100, 100);
-    if (velocityWindow.empty()) return 0.0;
-    
-    double sumVelocity = 0.0;
-    for (const auto& data : velocityWindow) {
-        sumVelocity += calculateVelocity(data);
-    }
-    return sumVelocity / velocityWindow.size();
+    return averageVelocity(event->samples, event->headWindow());
 }
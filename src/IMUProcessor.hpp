@@ -1,97 +1,125 @@
 #ifndef IMU_PROCESSOR_H
 #define IMU_PROCESSOR_H
 
-#include <vector>
-#include <deque>
 #include <cmath>
-#include <iostream>
 #include <limits>
 #include <cstdint>
 #include <cstring>
 #include <algorithm>
-#include <Arduino.h>
+#include "Calibration.hpp"
+#include "EventCapture.hpp"
+#include "Fusion.hpp"
+#include "ImpactMetrics.hpp"
+#include "SampleBuffer.hpp"
+#include "Scalar.hpp"
 
-#define G_CONSTANT 9.81  // m/s²
 #define IMPACT_THRESHOLD_LOW 2.5
 #define IMPACT_THRESHOLD_MEDIUM 5.0
 #define IMPACT_THRESHOLD_HIGH 7.5
 #define IMPACT_THRESHOLD_SEVERE 10.0
+// A longer step between samples is a gap in the stream (link drop, sensor
+// restart); nothing is integrated across it
+#define SAMPLE_GAP_MS 250
 
-// Simple quaternion representation
-struct Quaternion {
-    double w, x, y, z;
-    Quaternion(double w_=1, double x_=0, double y_=0, double z_=0)
-        : w(w_), x(x_), y(y_), z(z_) {}
-    
-    // Multiply this quaternion by another
-    Quaternion operator*(const Quaternion &o) const {
-        return Quaternion(
-            w*o.w - x*o.x - y*o.y - z*o.z,
-            w*o.x + x*o.w + y*o.z - z*o.y,
-            w*o.y - x*o.z + y*o.w + z*o.x,
-            w*o.z + x*o.y - y*o.x + z*o.w
-        );
-    }
-    
-    // Normalize quaternion
-    void normalize() {
-        double n = std::sqrt(w*w + x*x + y*y + z*z);
-        w /= n; x /= n; y /= n; z /= n;
-    }
-};
-
-struct IMUData {
-    uint32_t timestamp;
-    float accX, accY, accZ;
-    float gyroX, gyroY, gyroZ;
-    float velX, velY, velZ;
+// Largest motion seen over a span of samples
+struct ActivityPeak {
+    Scalar linAcc = 0;   // linear acceleration magnitude, m/s²
+    Scalar gyroMag = 0;  // rotation rate magnitude, rad/s
 };
 
+// One instance per sensor (see SensorHub). getInstance() is a shared
+// instance for tools that only ever process one stream.
 class IMUProcessor {
 public:
+    IMUProcessor() = default;
+    IMUProcessor(const IMUProcessor&) = delete;
+    IMUProcessor& operator=(const IMUProcessor&) = delete;
+    
     static IMUProcessor& getInstance() {
-        if (instance == nullptr) {
-            instance = new IMUProcessor();
-        }
-        return *instance;
+        static IMUProcessor instance;
+        return instance;
     }
 
+    // Drops the samples, orientation and impact capture; the bias estimate
+    // (stored or learned) is kept, so a restarted stream needs no new
+    // still period
+    void restart();
+    // restart() and forget the bias estimate too
     void clearData();
     void processData(float accX, float accY, float accZ, 
                     float gyroX, float gyroY, float gyroZ,
                     uint32_t timestamp);
+    // Process count samples in one call. acc and gyro hold count rows of
+    // xyz (the layout of a Movesense IMU6 block), timestamps one per row.
+    // Timestamps are in µs and may wrap; only their differences are used.
+    void processBatch(const float* acc, const float* gyro,
+                      const uint32_t* timestamps, size_t count);
+    
+    // Attitude filter used for gravity removal; takes effect from the next sample
+    void setFusionAlgorithm(FusionAlgorithm algorithm) { fusionAlgorithm = algorithm; }
+    FusionAlgorithm getFusionAlgorithm() const { return fusionAlgorithm; }
+    
+    // Start from a stored calibration. Detection is armed from the first
+    // sample either way; the bias is refined while the sensor lies still.
+    void setCalibration(const SensorCalibration& calibration);
+    // Current bias estimate; false while there is none
+    bool getCalibration(SensorCalibration& calibration) const;
+    // Still samples that went into the estimate since clearData()
+    uint32_t getCalibrationSamples() const { return biasEstimator.totalSamples(); }
+    
+    // Span captured around each impact (defaults EVENT_PRE/POST_TRIGGER_MS)
+    void setEventSpan(uint32_t preTriggerMs, uint32_t postTriggerMs) { eventCapture.configure(preTriggerMs, postTriggerMs); }
+    // Completed impact record, or nullptr. It stays frozen, and later
+    // impacts are not captured, until releaseImpactEvent().
+    const ImpactEvent* getImpactEvent() const { return eventCapture.ready(); }
+    void releaseImpactEvent() { eventCapture.release(); }
+    uint32_t getMissedImpactEvents() const { return eventCapture.missed(); }
+    // Impacts captured since restart(), and the latest one's trigger
+    // time; a new count means a trigger during the last processBatch()
+    uint32_t getCapturedImpacts() const { return eventCapture.captured(); }
+    uint32_t getLastTriggerTime() const { return eventCapture.triggerTime(); }
+    // Gaps in the sample timestamps seen since restart()
+    uint32_t getSampleGaps() const { return sampleGaps; }
+    // Peak motion since the previous call (or restart()), then start over
+    ActivityPeak takeActivityPeak();
     
-    // Impact metrics calculation methods
+    // Impact metrics calculation methods, evaluated on the completed
+    // impact record; all return 0 while there is none
     int getImpactLevel();
-    double getHIC(double window_ms = 15.0);
-    double getAccOnImpact();
-    double getRidingVelocitybeforeImpact();
-    double getHeadVelocityOnImpact();
+    // Level 0-4 for a peak linear acceleration
+    static int impactLevel(Scalar linearAcc);
+    Scalar getHIC(Scalar window_ms = 15.0);
+    HICResult getHIC15And36();
+    Scalar getAccOnImpact();
+    Scalar getRidingVelocitybeforeImpact();
+    Scalar getHeadVelocityOnImpact();
     
 private:
-    static IMUProcessor* instance;
-    std::deque<IMUData> imuDataBuffer;
-    const size_t MAX_BUFFER_SIZE = 500;
-    bool impactDetected = false;
+    // Under 5 s at the riding rate; the riding velocity looks further back
+    // through velocityHistory
+    static constexpr size_t MAX_BUFFER_SIZE = 500;
+    static constexpr size_t PROCESS_CHUNK_SIZE = 16;
+    StaticSampleBuffer<MAX_BUFFER_SIZE> imuDataBuffer;
+    VelocityHistory velocityHistory;
     uint32_t lastImpactTime = 0;
-    const uint32_t IMPACT_COOLDOWN = 2000;
-    Quaternion orientation;
+    uint32_t sampleGaps = 0;
+    ActivityPeak activityPeak;
+    EventCapture eventCapture;
+    const uint32_t IMPACT_COOLDOWN = 2000; // ms
+    FusionAlgorithm fusionAlgorithm = FusionAlgorithm::MAHONY;
+    FusionState fusion;
     
-    // Bias calculation
-    float biasAccX = 0.0f, biasAccY = 0.0f, biasAccZ = 0.0f;
-    float biasGyroX = 0.0f, biasGyroY = 0.0f, biasGyroZ = 0.0f;
-    bool biasCalculated = false;
-    const int BIAS_CALIBRATION_SAMPLES = 250;
+    // Bias, from the running estimate
+    Scalar biasAccX = 0, biasAccY = 0, biasAccZ = 0;
+    Scalar biasGyroX = 0, biasGyroY = 0, biasGyroZ = 0;
+    BiasEstimator biasEstimator;
+    bool attitudeAligned = false;
 
     // Helper methods
-    void updateOrientation(const IMUData& data, float dt);
-    void rotateGravity(const Quaternion& q, float& gx, float& gy, float& gz);
-    void updateBias(const IMUData& data);
-    double calculateLinearAcceleration(const IMUData& data);
-    double calculateAngularVelocity(const IMUData& data);
-    double calculateVelocity(const IMUData& data);
-    std::vector<IMUData> getImpactWindow(uint32_t impactTime, double window_ms);
-    Quaternion estimateOrientationFromAccel(const IMUData& data);
+    void updateOrientation(const IMUData& data, Scalar dt);
+    void applyBias();
+    void processChunk(const float* acc, const float* gyro,
+                      const uint32_t* timestamps, size_t n);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "ImpactMetrics.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+HICResult computeHIC(const SampleBuffer& buffer, SampleWindow window,
+                     Scalar shortWindowMs, Scalar longWindowMs) {
+    HICResult result;
+    if (window.size() < 2) return result;
+    if (shortWindowMs > longWindowMs) std::swap(shortWindowMs, longWindowMs);
+
+    computeHICStep(buffer, window, window.begin, window.size(), shortWindowMs, longWindowMs, result);
+    return result;
+}
+
+size_t computeHICStep(const SampleBuffer& buffer, SampleWindow window, size_t start, size_t maxStarts,
+                      Scalar shortWindowMs, Scalar longWindowMs, HICResult& result) {
+    PROFILE_SCOPE(HIC);
+    const uint32_t* timestamps = buffer.columns().timestamp;
+    const Scalar* linAcc = buffer.columns().linAcc;
+
+    const size_t stop = std::min(window.end, start + maxStarts);
+    size_t i = start;
+    for (; i < stop && i + 1 < window.end; ++i) {
+        const uint32_t ti = timestamps[buffer.slot(i)];
+
+        // sum = acc[i] + ... + acc[j], extended by one sample per step
+        Scalar sum = linAcc[buffer.slot(i)] / S(G_CONSTANT);
+        for (size_t j = i + 1; j < window.end; ++j) {
+            const size_t sj = buffer.slot(j);
+            Scalar dtMs = static_cast<Scalar>(timestamps[sj] - ti) / S(1000);
+            if (dtMs > longWindowMs) break;
+
+            sum += linAcc[sj] / S(G_CONSTANT);
+            Scalar avgAcc = sum / (j - i + 1);
+            // avg^2.5 without pow()
+            Scalar hic = (dtMs / S(1000)) * avgAcc * avgAcc * std::sqrt(avgAcc);
+
+            result.hic36 = std::max(result.hic36, hic);
+            if (dtMs <= shortWindowMs) {
+                result.hic15 = std::max(result.hic15, hic);
+            }
+        }
+    }
+
+    return i;
+}
+
+Scalar averageVelocity(const SampleBuffer& buffer, SampleWindow window) {
+    if (window.empty()) return 0;
+
+    return accumulateVelocity(buffer, window, 0) / window.size();
+}
+
+Scalar accumulateVelocity(const SampleBuffer& buffer, SampleWindow window, Scalar sum) {
+    const SampleColumns& c = buffer.columns();
+    for (size_t i = window.begin; i < window.end; ++i) {
+        const size_t s = buffer.slot(i);
+        sum += std::sqrt(c.velX[s]*c.velX[s] + c.velY[s]*c.velY[s] + c.velZ[s]*c.velZ[s]);
+    }
+    return sum;
+}
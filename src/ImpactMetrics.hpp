@@ -0,0 +1,44 @@
+#ifndef IMPACT_METRICS_H
+#define IMPACT_METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SampleBuffer.hpp"
+#include "Scalar.hpp"
+
+#define G_CONSTANT 9.81  // m/s²
+
+#define HIC15_WINDOW_MS 15.0
+#define HIC36_WINDOW_MS 36.0
+
+struct HICResult {
+    Scalar hic15 = 0;
+    Scalar hic36 = 0;
+};
+
+// Head Injury Criterion over a window of buffered samples.
+//
+// Uses the stored linear acceleration magnitude of each sample, in g. For
+// every pair of samples (i, j) no further apart than the window, the HIC
+// candidate is dt * avg(acc[i..j])^2.5; the result is the maximum. The
+// partial sums are carried forward from each start sample, so each pair
+// costs O(1) and the search is linear in the number of samples for a
+// fixed window. The short and long windows are evaluated in the same pass.
+HICResult computeHIC(const SampleBuffer& buffer, SampleWindow window,
+                     Scalar shortWindowMs = S(HIC15_WINDOW_MS), Scalar longWindowMs = S(HIC36_WINDOW_MS));
+
+// Resumable form of computeHIC for time-sliced callers. Evaluates the
+// start samples [start, start + maxStarts) of the window into result and
+// returns the next start to evaluate; the search is complete once that
+// reaches window.end - 1. The windows must already be ordered short, long.
+size_t computeHICStep(const SampleBuffer& buffer, SampleWindow window, size_t start, size_t maxStarts,
+                      Scalar shortWindowMs, Scalar longWindowMs, HICResult& result);
+
+// Mean velocity magnitude over a window of buffered samples
+Scalar averageVelocity(const SampleBuffer& buffer, SampleWindow window);
+
+// Adds the velocity magnitudes of a window to sum; averageVelocity of a
+// window equals the sum over consecutive pieces of it divided by its size
+Scalar accumulateVelocity(const SampleBuffer& buffer, SampleWindow window, Scalar sum);
+
+#endif
@@ -0,0 +1,46 @@
+#include "InternalFlash.hpp"
+
+// Target implementation; the host build provides its own in host/shims
+#if defined(ARDUINO_ARCH_MBED)
+
+#include "FlashIAP.h"
+
+// One controller shared by every region
+static mbed::FlashIAP flashIAP;
+static bool flashIAPReady = false;
+
+bool InternalFlash::begin() {
+    if (!flashIAPReady) {
+        if (flashIAP.init() != 0) return false;
+        flashIAPReady = true;
+    }
+    
+    const uint32_t end = flashIAP.get_flash_start() + flashIAP.get_flash_size();
+    if (size_ == 0 || size_ % INTERNAL_FLASH_PAGE_SIZE != 0 || endOffset_ % INTERNAL_FLASH_PAGE_SIZE != 0 ||
+        size_ + endOffset_ > flashIAP.get_flash_size() ||
+        flashIAP.get_sector_size(end - 1) != INTERNAL_FLASH_PAGE_SIZE) {
+        return false;
+    }
+    
+    base_ = end - endOffset_ - size_;
+    started_ = true;
+    return true;
+}
+
+bool InternalFlash::read(uint32_t address, void* data, uint32_t length) {
+    if (!inRange(address, length)) return false;
+    return flashIAP.read(data, base_ + address, length) == 0;
+}
+
+bool InternalFlash::program(uint32_t address, const void* data, uint32_t length) {
+    if (!inRange(address, length)) return false;
+    if (address % INTERNAL_FLASH_PROGRAM_UNIT != 0 || length % INTERNAL_FLASH_PROGRAM_UNIT != 0) return false;
+    return flashIAP.program(data, base_ + address, length) == 0;
+}
+
+bool InternalFlash::erase(uint32_t address) {
+    if (!inRange(address, INTERNAL_FLASH_PAGE_SIZE) || address % INTERNAL_FLASH_PAGE_SIZE != 0) return false;
+    return flashIAP.erase(base_ + address, INTERNAL_FLASH_PAGE_SIZE) == 0;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef INTERNAL_FLASH_H
+#define INTERNAL_FLASH_H
+
+#include <cstdint>
+#include "Flash.hpp"
+
+// nRF52840 page (erase unit) and word (program unit)
+#define INTERNAL_FLASH_PAGE_SIZE 4096
+#define INTERNAL_FLASH_PROGRAM_UNIT 4
+
+// A region at the top of the nRF52840's internal flash, above the sketch.
+// endOffset is the distance from the end of flash to the end of the
+// region, so several regions can be stacked below each other. On the host
+// the same regions live in a file-backed image (see host/shims).
+class InternalFlash : public Flash {
+public:
+    InternalFlash(uint32_t size, uint32_t endOffset = 0)
+        : size_(size), endOffset_(endOffset) {}
+    
+    bool begin();
+    
+    uint32_t size() const override { return size_; }
+    uint32_t pageSize() const override { return INTERNAL_FLASH_PAGE_SIZE; }
+    uint32_t programUnit() const override { return INTERNAL_FLASH_PROGRAM_UNIT; }
+    
+    bool read(uint32_t address, void* data, uint32_t length) override;
+    bool program(uint32_t address, const void* data, uint32_t length) override;
+    bool erase(uint32_t address) override;
+    
+private:
+    bool inRange(uint32_t address, uint32_t length) const {
+        return started_ && address <= size_ && length <= size_ - address;
+    }
+    
+    uint32_t size_;
+    uint32_t endOffset_;
+    uint32_t base_ = 0;
+    bool started_ = false;
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include "Kernels.hpp"
+
+#include <cmath>
+
+#if !defined(AXONA_DOUBLE_PRECISION)
+#  if defined(AXONA_USE_CMSIS_DSP) && defined(__ARM_FEATURE_DSP)
+#    include <arm_math.h>
+#    define KERNELS_CMSIS 1
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#    define KERNELS_SSE 1
+#  elif defined(__ARM_NEON) && defined(__aarch64__)
+#    include <arm_neon.h>
+#    define KERNELS_NEON 1
+#  endif
+#endif
+
+namespace kernels {
+
+namespace reference {
+
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = in[i] + c;
+}
+
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+}
+
+void trapezoid(const Scalar* a, const Scalar* dt, Scalar prevA, Scalar prevV, Scalar* v, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        prevV = prevV + (a[i] + prevA) * dt[i] / 2;
+        prevA = a[i];
+        v[i] = prevV;
+    }
+}
+
+} // namespace reference
+
+void deinterleave3(const float* xyz, Scalar* x, Scalar* y, Scalar* z, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = xyz[3 * i];
+        y[i] = xyz[3 * i + 1];
+        z[i] = xyz[3 * i + 2];
+    }
+}
+
+#if defined(KERNELS_CMSIS)
+
+const char* implementation() { return "cmsis-dsp"; }
+
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n) {
+    arm_offset_f32(const_cast<float32_t*>(in), c, out, n);
+}
+
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n) {
+    arm_sub_f32(const_cast<float32_t*>(a), const_cast<float32_t*>(b), out, n);
+}
+
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n) {
+    float32_t sq[32];
+    while (n > 0) {
+        size_t k = n < 32 ? n : 32;
+        arm_mult_f32(const_cast<float32_t*>(x), const_cast<float32_t*>(x), out, k);
+        arm_mult_f32(const_cast<float32_t*>(y), const_cast<float32_t*>(y), sq, k);
+        arm_add_f32(out, sq, out, k);
+        arm_mult_f32(const_cast<float32_t*>(z), const_cast<float32_t*>(z), sq, k);
+        arm_add_f32(out, sq, out, k);
+        for (size_t i = 0; i < k; ++i) arm_sqrt_f32(out[i], &out[i]);
+        x += k; y += k; z += k; out += k; n -= k;
+    }
+}
+
+#elif defined(KERNELS_SSE)
+
+const char* implementation() { return "sse2"; }
+
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n) {
+    const __m128 vc = _mm_set1_ps(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(in + i), vc));
+    }
+    reference::offset(in + i, c, out + i, n - i);
+}
+
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    reference::subtract(a + i, b + i, out + i, n - i);
+}
+
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(sum));
+    }
+    reference::magnitude3(x + i, y + i, z + i, out + i, n - i);
+}
+
+#elif defined(KERNELS_NEON)
+
+const char* implementation() { return "neon"; }
+
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n) {
+    const float32x4_t vc = vdupq_n_f32(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vaddq_f32(vld1q_f32(in + i), vc));
+    }
+    reference::offset(in + i, c, out + i, n - i);
+}
+
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    reference::subtract(a + i, b + i, out + i, n - i);
+}
+
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t vx = vld1q_f32(x + i);
+        float32x4_t vy = vld1q_f32(y + i);
+        float32x4_t vz = vld1q_f32(z + i);
+        float32x4_t sum = vaddq_f32(vaddq_f32(vmulq_f32(vx, vx), vmulq_f32(vy, vy)), vmulq_f32(vz, vz));
+        vst1q_f32(out + i, vsqrtq_f32(sum));
+    }
+    reference::magnitude3(x + i, y + i, z + i, out + i, n - i);
+}
+
+#else
+
+const char* implementation() { return "scalar"; }
+
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n) {
+    reference::offset(in, c, out, n);
+}
+
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n) {
+    reference::subtract(a, b, out, n);
+}
+
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n) {
+    reference::magnitude3(x, y, z, out, n);
+}
+
+#endif
+
+// The per-sample increments are independent and vectorize; the running
+// sum over them is inherently sequential.
+void trapezoid(const Scalar* a, const Scalar* dt, Scalar prevA, Scalar prevV, Scalar* v, size_t n) {
+    if (n == 0) return;
+
+    // v holds the increments first
+    v[0] = (a[0] + prevA) * dt[0] / 2;
+    size_t i = 1;
+#if defined(KERNELS_SSE)
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(a + i - 1));
+        _mm_storeu_ps(v + i, _mm_mul_ps(_mm_mul_ps(sum, _mm_loadu_ps(dt + i)), half));
+    }
+#elif defined(KERNELS_NEON)
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t sum = vaddq_f32(vld1q_f32(a + i), vld1q_f32(a + i - 1));
+        vst1q_f32(v + i, vmulq_f32(vmulq_f32(sum, vld1q_f32(dt + i)), half));
+    }
+#endif
+    for (; i < n; ++i) {
+        v[i] = (a[i] + a[i - 1]) * dt[i] / 2;
+    }
+
+    for (size_t k = 0; k < n; ++k) {
+        prevV = prevV + v[k];
+        v[k] = prevV;
+    }
+}
+
+} // namespace kernels
@@ -0,0 +1,46 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+#include "Scalar.hpp"
+
+// Batch kernels for the per-sample arithmetic of the processing pipeline.
+//
+// All kernels work on structure-of-arrays inputs of n elements. Each has a
+// portable scalar reference in kernels::reference; the unqualified version
+// dispatches to SSE (x86), NEON (AArch64) or CMSIS-DSP (Cortex-M4 with
+// AXONA_USE_CMSIS_DSP) when Scalar is float, and to the reference
+// otherwise. The SIMD paths perform the same operations in the same order,
+// so results match the reference exactly unless the compiler contracts
+// multiply-adds.
+namespace kernels {
+
+// out[i] = in[i] + c
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n);
+
+// out[i] = a[i] - b[i]
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n);
+
+// out[i] = sqrt(x[i]^2 + y[i]^2 + z[i]^2)
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n);
+
+// Trapezoidal integration: v[i] = v[i-1] + (a[i] + a[i-1]) * dt[i] / 2,
+// with a[-1] = prevA and v[-1] = prevV
+void trapezoid(const Scalar* a, const Scalar* dt, Scalar prevA, Scalar prevV, Scalar* v, size_t n);
+
+// Split n interleaved xyz triples into three arrays
+void deinterleave3(const float* xyz, Scalar* x, Scalar* y, Scalar* z, size_t n);
+
+// Name of the implementation the dispatching kernels use
+const char* implementation();
+
+namespace reference {
+void offset(const Scalar* in, Scalar c, Scalar* out, size_t n);
+void subtract(const Scalar* a, const Scalar* b, Scalar* out, size_t n);
+void magnitude3(const Scalar* x, const Scalar* y, const Scalar* z, Scalar* out, size_t n);
+void trapezoid(const Scalar* a, const Scalar* dt, Scalar prevA, Scalar prevV, Scalar* v, size_t n);
+} // namespace reference
+
+} // namespace kernels
+
+#endif
@@ -0,0 +1,53 @@
+#include "LatencyTrace.hpp"
+
+void LatencyTrace::record(TraceStage stage, uint8_t sensor, uint32_t sensorUs, uint32_t receiverUs) {
+    TraceEntry& entry = entries_[count_ % LATENCY_TRACE_SIZE];
+    entry.sensorUs = sensorUs;
+    entry.receiverUs = receiverUs;
+    entry.stage = static_cast<uint8_t>(stage);
+    entry.sensor = sensor;
+    count_++;
+}
+
+void LatencyTrace::clear() {
+    count_ = 0;
+}
+
+const TraceEntry& LatencyTrace::at(size_t i) const {
+    const uint32_t oldest = count_ - static_cast<uint32_t>(size());
+    return entries_[(oldest + i) % LATENCY_TRACE_SIZE];
+}
+
+const char* LatencyTrace::stageName(TraceStage stage) {
+    static const char* const names[] = {"sample", "arrival", "ingest", "detect", "capture", "led", "metrics"};
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(TraceStage::COUNT),
+                  "one name per stage");
+    return stage < TraceStage::COUNT ? names[static_cast<size_t>(stage)] : "?";
+}
+
+void PacketArrivals::add(uint32_t firstUs, uint32_t lastUs, uint32_t arrivalUs) {
+    Packet& packet = packets_[count_ % PACKET_ARRIVALS_SIZE];
+    packet.firstUs = firstUs;
+    packet.lastUs = lastUs;
+    packet.arrivalUs = arrivalUs;
+    packet.ingestUs = arrivalUs;
+    count_++;
+}
+
+void PacketArrivals::queued(uint32_t ingestUs) {
+    if (count_ > 0) {
+        packets_[(count_ - 1) % PACKET_ARRIVALS_SIZE].ingestUs = ingestUs;
+    }
+}
+
+const PacketArrivals::Packet* PacketArrivals::find(uint32_t sampleUs) const {
+    const uint32_t held = count_ < PACKET_ARRIVALS_SIZE ? count_ : PACKET_ARRIVALS_SIZE;
+    // Newest first; times compare by difference, like everywhere else
+    for (uint32_t n = 1; n <= held; ++n) {
+        const Packet& packet = packets_[(count_ - n) % PACKET_ARRIVALS_SIZE];
+        if (sampleUs - packet.firstUs <= packet.lastUs - packet.firstUs) {
+            return &packet;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,87 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Trace entries kept; about ten impacts' worth
+#define LATENCY_TRACE_SIZE 64
+// Recent packets whose arrival times a pipeline remembers, enough to cover
+// what loop() leaves in the sample queue between two drains
+#define PACKET_ARRIVALS_SIZE 16
+
+// Points an impact passes on its way to the LEDs, in order
+enum class TraceStage : uint8_t {
+    SAMPLE,     // trigger sample taken, on the receiver clock (ClockAlignment)
+    ARRIVAL,    // notification callback entered for the packet holding it
+    INGEST,     // that packet's rows queued
+    DETECT,     // loop() saw the trigger after draining the queue
+    CAPTURE,    // record complete, metric job started
+    LED,        // LEDs written, once the job has the impact level
+    METRICS,    // metric job finished
+    COUNT
+};
+
+// One stage of one impact. Impacts are told apart by sensor and trigger
+// time (sensor clock, µs); receiverUs is micros() when the stage was
+// reached.
+struct TraceEntry {
+    uint32_t sensorUs;
+    uint32_t receiverUs;
+    uint8_t stage;
+    uint8_t sensor;
+};
+
+// Ring of the latest trace entries, oldest overwritten first.
+//
+// Fixed size, no allocation; record() is a few stores, so it can stay in
+// release builds. Export with the trace command and analyse with the
+// host's latency_report.
+class LatencyTrace {
+public:
+    void record(TraceStage stage, uint8_t sensor, uint32_t sensorUs, uint32_t receiverUs);
+    void clear();
+
+    size_t size() const { return count_ < LATENCY_TRACE_SIZE ? count_ : LATENCY_TRACE_SIZE; }
+    // i = 0 is the oldest entry still held
+    const TraceEntry& at(size_t i) const;
+    // Entries lost to wrap-around since clear()
+    uint32_t overwritten() const { return count_ > LATENCY_TRACE_SIZE ? count_ - LATENCY_TRACE_SIZE : 0; }
+
+    static const char* stageName(TraceStage stage);
+
+private:
+    TraceEntry entries_[LATENCY_TRACE_SIZE];
+    uint32_t count_ = 0;
+};
+
+// Arrival and queueing times of a pipeline's latest packets, so loop() can
+// trace back when the packet holding a trigger sample came in.
+//
+// Written by the BLE callback and read from loop(). In the sketch both run
+// on the same thread (the callback is called from BLE.poll()); a threaded
+// producer would need its own synchronisation.
+class PacketArrivals {
+public:
+    struct Packet {
+        uint32_t firstUs;      // first and last row, sensor clock
+        uint32_t lastUs;
+        uint32_t arrivalUs;    // receiver micros()
+        uint32_t ingestUs;
+    };
+
+    void reset() { count_ = 0; }
+    // Producer: a packet whose rows span firstUs..lastUs arrived
+    void add(uint32_t firstUs, uint32_t lastUs, uint32_t arrivalUs);
+    // Producer: the latest packet's rows are queued
+    void queued(uint32_t ingestUs);
+    // Packet holding the sample taken at sampleUs, or nullptr if it has
+    // already left the ring
+    const Packet* find(uint32_t sampleUs) const;
+
+private:
+    Packet packets_[PACKET_ARRIVALS_SIZE];
+    uint32_t count_ = 0;
+};
+
+#endif
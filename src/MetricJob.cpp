@@ -0,0 +1,100 @@
+#include "MetricJob.hpp"
+
+#include <algorithm>
+
+#include "IMUProcessor.hpp"
+
+void MetricJob::start(const ImpactEvent& event) {
+    event_ = &event;
+    report_ = ImpactReport();
+    report_.triggerTime = event.triggerTime;
+    if (!event.samples.empty()) {
+        report_.peakAcc = event.samples.linAcc(event.triggerIndex);
+    }
+    stage_ = Stage::LEVEL;
+    next_ = event.postTrigger().begin;
+    sum_ = 0;
+}
+
+bool MetricJob::run(uint32_t budgetUs) {
+    if (!busy()) return done();
+    
+    const unsigned long begin = clock_();
+    unsigned long elapsed = 0;
+    // Always make progress, even with a zero budget
+    bool level = false;
+    do {
+        level = stage_ == Stage::LEVEL;
+        step();
+        elapsed = clock_() - begin;
+    } while (busy() && elapsed < budgetUs && !level);
+    
+    longestRunUs_ = std::max(longestRunUs_, static_cast<uint32_t>(elapsed));
+    return done();
+}
+
+void MetricJob::step() {
+    const SampleBuffer& samples = event_->samples;
+    
+    switch (stage_) {
+        case Stage::LEVEL: {
+            // Peak over the post-trigger span; short, done in one slice
+            SampleWindow window = event_->postTrigger();
+            Scalar peak = 0;
+            for (size_t i = window.begin; i < window.end; ++i) {
+                peak = std::max(peak, samples.linAcc(i));
+            }
+            report_.level = IMUProcessor::impactLevel(peak);
+            stage_ = Stage::HIC;
+            next_ = window.begin;
+            break;
+        }
+        
+        case Stage::HIC: {
+            SampleWindow window = event_->postTrigger();
+            if (window.size() >= 2) {
+                next_ = computeHICStep(samples, window, next_, METRIC_JOB_HIC_SLICE,
+                                       S(HIC15_WINDOW_MS), S(HIC36_WINDOW_MS), report_.hic);
+            }
+            if (window.size() < 2 || next_ + 1 >= window.end) {
+                stage_ = Stage::RIDING_VELOCITY;
+            }
+            break;
+        }
+        
+        case Stage::RIDING_VELOCITY:
+            // At most VELOCITY_HISTORY_BINS bins; done in one slice
+            report_.ridingVelocity = event_->ridingVelocity();
+            stage_ = Stage::HEAD_VELOCITY;
+            next_ = event_->headWindow().begin;
+            sum_ = 0;
+            break;
+        
+        case Stage::HEAD_VELOCITY:
+            if (velocityStep(event_->headWindow(), report_.headVelocity)) {
+                stage_ = Stage::DONE;
+            }
+            break;
+        
+        case Stage::IDLE:
+        case Stage::DONE:
+            break;
+    }
+}
+
+bool MetricJob::velocityStep(SampleWindow window, Scalar& out) {
+    if (window.empty()) {
+        out = 0;
+        return true;
+    }
+    
+    SampleWindow slice;
+    slice.begin = next_;
+    slice.end = std::min(window.end, next_ + METRIC_JOB_VELOCITY_SLICE);
+    sum_ = accumulateVelocity(event_->samples, slice, sum_);
+    next_ = slice.end;
+    
+    if (next_ < window.end) return false;
+    out = sum_ / window.size();
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef METRIC_JOB_H
+#define METRIC_JOB_H
+
+#include <cstddef>
+#include <cstdint>
+#include "EventCapture.hpp"
+#include "ImpactMetrics.hpp"
+#include "Scalar.hpp"
+
+// Time allowed per loop() iteration for metric work, in microseconds
+#define METRIC_JOB_BUDGET_US 500
+// HIC start samples / velocity samples evaluated between clock checks
+#define METRIC_JOB_HIC_SLICE 4
+#define METRIC_JOB_VELOCITY_SLICE 32
+
+// Everything loop() reports for one impact
+struct ImpactReport {
+    uint32_t triggerTime = 0;     // sensor clock, µs
+    int level = 0;
+    HICResult hic;
+    Scalar peakAcc = 0;
+    Scalar ridingVelocity = 0;
+    Scalar headVelocity = 0;
+};
+
+// Computes the metrics of a frozen ImpactEvent in small slices, so that
+// loop() can keep polling BLE and draining samples in between.
+//
+// start() points the job at a completed record; each run() call then works
+// until the budget is spent and returns true once the report is complete.
+// The level comes first and run() returns as soon as it is known, so the
+// caller can light the LEDs before the HIC search and velocities.
+// Results are identical to the one-shot IMUProcessor getters. The record
+// must stay frozen (not released) until the job is done.
+class MetricJob {
+public:
+    // Monotonic microsecond clock, e.g. micros()
+    typedef unsigned long (*Clock)();
+    
+    explicit MetricJob(Clock clock) : clock_(clock) {}
+    
+    void start(const ImpactEvent& event);
+    bool run(uint32_t budgetUs = METRIC_JOB_BUDGET_US);
+    void reset() { stage_ = Stage::IDLE; event_ = nullptr; }
+    
+    bool busy() const { return stage_ != Stage::IDLE && stage_ != Stage::DONE; }
+    bool done() const { return stage_ == Stage::DONE; }
+    // report().level is final
+    bool levelReady() const { return stage_ > Stage::LEVEL; }
+    const ImpactReport& report() const { return report_; }
+    
+    // Longest single run() call so far, in microseconds
+    uint32_t longestRunUs() const { return longestRunUs_; }
+    
+private:
+    enum class Stage : uint8_t {
+        IDLE,
+        LEVEL,
+        HIC,
+        RIDING_VELOCITY,
+        HEAD_VELOCITY,
+        DONE
+    };
+    
+    // Advances the current stage by one slice
+    void step();
+    // Sums one slice of a velocity window; true when the window is done
+    bool velocityStep(SampleWindow window, Scalar& out);
+    
+    Clock clock_;
+    const ImpactEvent* event_ = nullptr;
+    Stage stage_ = Stage::IDLE;
+    size_t next_ = 0;
+    Scalar sum_ = 0;
+    ImpactReport report_;
+    uint32_t longestRunUs_ = 0;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "MovesenseIMU6.hpp"
+
+#include <cstring>
+
+/**
+ * @brief Decode the header of a Movesense IMU6 notification
+ * 
+ * Does not copy the payload; the returned packet points into data and is
+ * only valid while the notification buffer is.
+ * 
+ * @param data Raw notification payload
+ * @param length Length of the payload in bytes
+ * @param packet Receives the decoded header
+ * @param sampleRate Subscribed rate in Hz, 0 to derive it from the row count
+ * @return IMU6Status::OK if the packet can be processed
+ */
+IMU6Status decodeIMU6Packet(const uint8_t* data, size_t length, IMU6Packet& packet, int sampleRate) {
+    if (length < IMU6_MIN_LENGTH) {
+        return IMU6Status::TOO_SHORT;
+    }
+    if (length > IMU6_MAX_LENGTH) {
+        return IMU6Status::TOO_LONG;
+    }
+
+    DataView dv(data, length);
+
+    packet.data = data;
+    packet.length = length;
+    packet.packetType = dv.getUint8(0);
+    packet.reference = dv.getUint8(1);
+    packet.timestamp = dv.getUint32(2);
+
+    packet.numRows = (length - 2) / (2 * IMU6_SENSOR_DATA_SIZE);
+    packet.sampleRate = sampleRate > 0 ? sampleRate : packet.numRows * 13;
+
+    // Validate the whole payload once so rows can be read without bounds checks
+    if (static_cast<size_t>(IMU6_HEADER_SIZE + 2 * packet.numRows * IMU6_SENSOR_DATA_SIZE) > length) {
+        return IMU6Status::TRUNCATED;
+    }
+    return IMU6Status::OK;
+}
+
+/**
+ * @brief Build a GSP subscribe request for the IMU6 stream
+ * 
+ * @param command Receives the request, at least IMU6_COMMAND_MAX bytes
+ * @param reference Reference the sensor tags the data packets with
+ * @param sampleRate Rate in Hz, one the sensor supports (13, 26, 52, ... 833)
+ * @return int Length of the request
+ */
+int imu6SubscribeCommand(uint8_t* command, uint8_t reference, int sampleRate) {
+    static const char path[] = "/Meas/IMU6/";
+    int length = 0;
+    command[length++] = GSP_COMMAND_SUBSCRIBE;
+    command[length++] = reference;
+    memcpy(command + length, path, sizeof(path) - 1);
+    length += sizeof(path) - 1;
+
+    char digits[4];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + sampleRate % 10);
+        sampleRate /= 10;
+    } while (sampleRate > 0 && count < 4);
+    while (count > 0) {
+        command[length++] = static_cast<uint8_t>(digits[--count]);
+    }
+    return length;
+}
+
+void IMU6Packet::readRow(int row, float* acc, float* gyro, uint32_t& rowTimestampUs) const {
+    DataView dv(data, length);
+
+    rowTimestampUs = this->rowTimestampUs(row);
+
+    const size_t accOffset = IMU6_HEADER_SIZE + row * IMU6_SENSOR_DATA_SIZE;
+    acc[0] = dv.getFloat32(accOffset);
+    acc[1] = dv.getFloat32(accOffset + 4);
+    acc[2] = dv.getFloat32(accOffset + 8);
+
+    const size_t gyroOffset = IMU6_HEADER_SIZE + numRows * IMU6_SENSOR_DATA_SIZE + row * IMU6_SENSOR_DATA_SIZE;
+    gyro[0] = dv.getFloat32(gyroOffset);
+    gyro[1] = dv.getFloat32(gyroOffset + 4);
+    gyro[2] = dv.getFloat32(gyroOffset + 8);
+}
+
+int processIMU6Packet(const IMU6Packet& packet, IMUProcessor& processor) {
+    const int numRows = packet.numRows;
+    if (numRows <= 0 || numRows > IMU6_MAX_ROWS) return 0;
+
+    uint32_t timestamps[IMU6_MAX_ROWS];
+    for (int i = 0; i < numRows; ++i) {
+        timestamps[i] = packet.rowTimestampUs(i);
+    }
+
+    // The acc/gyro blocks start 6 bytes into the payload, so they are only
+    // float-aligned if the stack hands us a suitably offset buffer. Use them
+    // in place when possible; otherwise take one aligned copy of each block
+    // (a misaligned float load faults on the Cortex-M4 FPU).
+    const uint8_t* accBytes = packet.accBlock();
+    const uint8_t* gyroBytes = packet.gyroBlock();
+    const size_t blockSize = numRows * IMU6_SENSOR_DATA_SIZE;
+
+    float accAligned[IMU6_MAX_ROWS * 3];
+    float gyroAligned[IMU6_MAX_ROWS * 3];
+    const float* acc = accAligned;
+    const float* gyro = gyroAligned;
+
+    if (reinterpret_cast<uintptr_t>(accBytes) % alignof(float) == 0) {
+        acc = reinterpret_cast<const float*>(accBytes);
+        gyro = reinterpret_cast<const float*>(gyroBytes);
+    } else {
+        memcpy(accAligned, accBytes, blockSize);
+        memcpy(gyroAligned, gyroBytes, blockSize);
+    }
+
+    processor.processBatch(acc, gyro, timestamps, numRows);
+    return numRows;
+}
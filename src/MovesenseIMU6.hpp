@@ -0,0 +1,75 @@
+#ifndef MOVESENSE_IMU6_H
+#define MOVESENSE_IMU6_H
+
+#include <cstddef>
+#include <cstdint>
+#include "DataView.hpp"
+#include "IMUProcessor.hpp"
+
+// GATT Sensor Protocol (GSP) service: commands are written to the write
+// characteristic, responses and measurement data arrive on the notify one
+#define MOVESENSE_GSP_SERVICE_UUID "34802252-7185-4d5d-b431-630e7050e8f0"
+#define MOVESENSE_GSP_WRITE_UUID "34800001-7185-4d5d-b431-630e7050e8f0"
+#define MOVESENSE_GSP_NOTIFY_UUID "34800002-7185-4d5d-b431-630e7050e8f0"
+// GSP requests: [command][reference][path...]; data packets carry the
+// reference of the subscription they belong to
+#define GSP_COMMAND_SUBSCRIBE 1
+#define GSP_COMMAND_UNSUBSCRIBE 2
+// Longest IMU6 subscribe request ("/Meas/IMU6/" and up to 4 digits)
+#define IMU6_COMMAND_MAX 17
+
+#define IMU6_HEADER_SIZE 6
+#define IMU6_SENSOR_DATA_SIZE 12
+#define IMU6_MIN_LENGTH 6
+// Largest notification with the nRF52840's 247-byte ATT MTU
+#define IMU6_MAX_LENGTH 244
+#define IMU6_MAX_ROWS ((IMU6_MAX_LENGTH - IMU6_HEADER_SIZE) / (2 * IMU6_SENSOR_DATA_SIZE))
+
+enum class IMU6Status {
+    OK,
+    TOO_SHORT,
+    TOO_LONG,
+    TRUNCATED   // header announces more rows than the payload holds
+};
+
+// Decoded view of a Movesense /Meas/IMU6 notification.
+//
+// Layout: [type:u8][reference:u8][timestamp:u32][acc xyz * numRows][gyro xyz * numRows],
+// all values little-endian. timestamp is the sensor's time of the first
+// row in ms. The packet does not own the payload.
+struct IMU6Packet {
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    uint8_t packetType = 0;
+    uint8_t reference = 0;
+    uint32_t timestamp = 0;
+    int numRows = 0;
+    int sampleRate = 0;
+
+    // Nominal time of a row in µs: the packet time plus row / sampleRate.
+    // SampleClock gives steadier times for a stream of packets.
+    uint32_t rowTimestampUs(int row) const {
+        return timestamp * 1000u + static_cast<uint32_t>(static_cast<uint64_t>(row) * 1000000u / sampleRate);
+    }
+
+    // Read one row of the packet into acc/gyro (3 floats each)
+    void readRow(int row, float* acc, float* gyro, uint32_t& rowTimestampUs) const;
+
+    // Start of the acc and gyro blocks, numRows * xyz little-endian floats each
+    const uint8_t* accBlock() const { return data + IMU6_HEADER_SIZE; }
+    const uint8_t* gyroBlock() const { return data + IMU6_HEADER_SIZE + numRows * IMU6_SENSOR_DATA_SIZE; }
+};
+
+// sampleRate is the rate the stream was subscribed at. 0 takes the row
+// count times 13 Hz, which is how the sensor packs rates up to 104 Hz.
+IMU6Status decodeIMU6Packet(const uint8_t* data, size_t length, IMU6Packet& packet, int sampleRate = 0);
+
+// Build the GSP request for /Meas/IMU6/<sampleRate> under reference;
+// command must hold IMU6_COMMAND_MAX bytes. Returns its length.
+int imu6SubscribeCommand(uint8_t* command, uint8_t reference, int sampleRate);
+
+// Feed every row of a decoded packet to the processor in one batch, at
+// their nominal times; returns the number of rows processed
+int processIMU6Packet(const IMU6Packet& packet, IMUProcessor& processor);
+
+#endif
@@ -0,0 +1,79 @@
+#include "Profiler.hpp"
+
+#ifdef AXONA_PROFILE
+
+#if !defined(PROFILE_DWT_CYCCNT) && !defined(PROFILE_TSC)
+#include <chrono>
+#endif
+
+namespace profiler {
+
+namespace {
+
+PROFILE_THREAD_LOCAL ProfileStats stageStats[static_cast<size_t>(ProfileStage::COUNT)];
+
+const char* const STAGE_NAMES[] = {"decode", "process", "orientation", "hic", "loop"};
+static_assert(sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) == static_cast<size_t>(ProfileStage::COUNT),
+              "one name per stage");
+
+int bucketFor(uint32_t cycles) {
+    int bucket = 0;
+    while (cycles > 1) {
+        cycles >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+}
+
+void begin() {
+#ifdef PROFILE_DWT_CYCCNT
+    // DEMCR.TRCENA powers the DWT, DWT_CTRL.CYCCNTENA starts the counter
+    *reinterpret_cast<volatile uint32_t*>(0xE000EDFC) |= (1u << 24);
+    *reinterpret_cast<volatile uint32_t*>(0xE0001000) |= 1u;
+#endif
+    reset();
+}
+
+#if !defined(PROFILE_DWT_CYCCNT) && !defined(PROFILE_TSC)
+uint32_t cycles() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+void record(ProfileStage stage, uint32_t cycles) {
+    ProfileStats& s = stageStats[static_cast<size_t>(stage)];
+    if (s.count == 0 || cycles < s.minCycles) s.minCycles = cycles;
+    if (cycles > s.maxCycles) s.maxCycles = cycles;
+    s.count++;
+    s.totalCycles += cycles;
+    s.buckets[bucketFor(cycles)]++;
+}
+
+const ProfileStats& stats(ProfileStage stage) {
+    return stageStats[static_cast<size_t>(stage)];
+}
+
+void reset() {
+    for (ProfileStats& s : stageStats) {
+        s = ProfileStats();
+    }
+}
+
+const char* stageName(ProfileStage stage) {
+    return STAGE_NAMES[static_cast<size_t>(stage)];
+}
+
+const char* unit() {
+#if defined(PROFILE_DWT_CYCCNT) || defined(PROFILE_TSC)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Uncomment (or build with -DAXONA_PROFILE) to time the pipeline stages
+// #define AXONA_PROFILE
+
+#ifdef AXONA_PROFILE
+#  if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#    define PROFILE_DWT_CYCCNT (*reinterpret_cast<volatile uint32_t*>(0xE0001004))
+#  elif defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define PROFILE_TSC 1
+#  endif
+// Per-thread stats off the target (see below)
+#  ifdef PROFILE_DWT_CYCCNT
+#    define PROFILE_THREAD_LOCAL
+#  else
+#    define PROFILE_THREAD_LOCAL thread_local
+#  endif
+#endif
+
+// Log2 histogram: bucket k counts durations of [2^k, 2^(k+1)) cycles,
+// bucket 0 also takes 0 and 1
+#define PROFILE_BUCKETS 32
+
+// Timed stages of the pipeline
+enum class ProfileStage : uint8_t {
+    DECODE,         // notification callback: IMU6 decode and ingest
+    PROCESS,        // IMUProcessor::processBatch
+    ORIENTATION,    // IMUProcessor::updateOrientation, per sample
+    HIC,            // computeHICStep, per slice
+    LOOP,           // one loop() iteration
+    COUNT
+};
+
+struct ProfileStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t buckets[PROFILE_BUCKETS];
+};
+
+// Per-stage cycle counts in fixed memory.
+//
+// The counter is the DWT cycle counter on the Cortex-M4, the TSC on x86
+// and steady_clock nanoseconds elsewhere (see unit()). Durations are taken
+// as 32-bit differences, so one scope may last up to 2^32 counts (67 s at
+// 64 MHz). On the Nano the stats are plain globals, as the sketch runs on
+// one thread (the callback is called from BLE.poll() in loop()). On the
+// host they are thread_local, because the benchmarks and fleet_analyzer
+// run the pipeline on several threads; stats() and reset() then only see
+// the calling thread's stages.
+//
+// Without AXONA_PROFILE the PROFILE_SCOPE macro expands to nothing and no
+// counters are kept.
+namespace profiler {
+
+#ifdef AXONA_PROFILE
+
+// Enables the cycle counter; call once from setup()
+void begin();
+
+#if defined(PROFILE_DWT_CYCCNT)
+inline uint32_t cycles() { return PROFILE_DWT_CYCCNT; }
+#elif defined(PROFILE_TSC)
+inline uint32_t cycles() { return static_cast<uint32_t>(__rdtsc()); }
+#else
+uint32_t cycles();
+#endif
+void record(ProfileStage stage, uint32_t cycles);
+
+// Stats of one stage since the last reset()
+const ProfileStats& stats(ProfileStage stage);
+void reset();
+
+const char* stageName(ProfileStage stage);
+// "cycles" or "ns"
+const char* unit();
+
+#else
+
+inline void begin() {}
+
+#endif
+
+}
+
+#ifdef AXONA_PROFILE
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : stage_(stage), start_(profiler::cycles()) {}
+    ~ProfileScope() { profiler::record(stage_, profiler::cycles() - start_); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileStage stage_;
+    uint32_t start_;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// Times the rest of the enclosing block as one run of the stage
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(ProfileStage::stage)
+
+#else
+
+#define PROFILE_SCOPE(stage)
+
+#endif
+
+#endif
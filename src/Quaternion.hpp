@@ -0,0 +1,33 @@
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include <cmath>
+#include "Scalar.hpp"
+
+// Simple quaternion representation
+template <typename T>
+struct QuaternionT {
+    T w, x, y, z;
+    QuaternionT(T w_=1, T x_=0, T y_=0, T z_=0)
+        : w(w_), x(x_), y(y_), z(z_) {}
+    
+    // Multiply this quaternion by another
+    QuaternionT operator*(const QuaternionT &o) const {
+        return QuaternionT(
+            w*o.w - x*o.x - y*o.y - z*o.z,
+            w*o.x + x*o.w + y*o.z - z*o.y,
+            w*o.y - x*o.z + y*o.w + z*o.x,
+            w*o.z + x*o.y - y*o.x + z*o.w
+        );
+    }
+    
+    // Normalize quaternion
+    void normalize() {
+        T n = std::sqrt(w*w + x*x + y*y + z*z);
+        w /= n; x /= n; y /= n; z /= n;
+    }
+};
+
+typedef QuaternionT<Scalar> Quaternion;
+
+#endif
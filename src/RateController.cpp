@@ -0,0 +1,41 @@
+#include "RateController.hpp"
+
+void RateController::reset(uint32_t nowMs) {
+    tier_ = 1;
+    heldSince_ = nowMs;
+    lastMotion_ = nowMs;
+}
+
+int RateController::tierRate(int tier) {
+    static const int rates[RATE_TIER_COUNT] = {
+        RATE_TIER_PARKED, RATE_TIER_RIDING, RATE_TIER_ROUGH, RATE_TIER_IMPACT
+    };
+    return rates[tier];
+}
+
+int RateController::tierFor(const ActivityPeak& peak) {
+    if (peak.linAcc >= S(RATE_IMPACT_ACC)) return 3;
+    if (peak.linAcc >= S(RATE_ROUGH_ACC)) return 2;
+    if (peak.linAcc >= S(RATE_MOTION_ACC) || peak.gyroMag >= S(RATE_MOTION_GYRO)) return 1;
+    return 0;
+}
+
+int RateController::update(const ActivityPeak& peak, uint32_t nowMs) {
+    const int wanted = tierFor(peak);
+    if (wanted > 0) {
+        lastMotion_ = nowMs;
+    }
+    
+    if (wanted >= tier_) {
+        // Up at once; the same tier again restarts the hold
+        tier_ = wanted;
+        heldSince_ = nowMs;
+    } else if (nowMs - heldSince_ >= RATE_HOLD_MS) {
+        // Down one tier per hold; parked only after a long stillness
+        if (tier_ > 1 || nowMs - lastMotion_ >= RATE_PARKED_MS) {
+            tier_--;
+            heldSince_ = nowMs;
+        }
+    }
+    return rate();
+}
@@ -0,0 +1,57 @@
+#ifndef RATE_CONTROLLER_H
+#define RATE_CONTROLLER_H
+
+#include <cstdint>
+#include "IMUProcessor.hpp"
+#include "Scalar.hpp"
+
+// IMU6 rates (Hz) the stream is switched between: parked, riding, rough
+// riding, and around an impact
+#define RATE_TIER_COUNT 4
+#define RATE_TIER_PARKED 26
+#define RATE_TIER_RIDING 104
+#define RATE_TIER_ROUGH 416
+#define RATE_TIER_IMPACT 833
+// Any rotation (rad/s) or linear acceleration (m/s²) above these is motion
+#define RATE_MOTION_GYRO 0.3
+#define RATE_MOTION_ACC 0.8
+// Linear acceleration peaks (m/s²) that raise the rate. IMPACT sits below
+// IMPACT_THRESHOLD_LOW, so a secondary hit (the head after the bike) is
+// captured at the full rate.
+#define RATE_ROUGH_ACC 1.5
+#define RATE_IMPACT_ACC 2.0
+// A raised rate is held this long after the last peak that asked for it,
+// then steps down one tier per hold
+#define RATE_HOLD_MS 5000
+// The parked rate is only taken after this long without motion
+#define RATE_PARKED_MS 30000
+
+// Picks the IMU6 subscription rate of one sensor from its recent motion.
+//
+// Rates go up as soon as a peak asks for it and come down one tier at a
+// time, so a bumpy stretch does not flip the subscription back and forth.
+// Switching is left to the caller; IMUProcessor works from the sample
+// timestamps, so orientation, velocity and the sample buffer carry over
+// a rate change unchanged.
+class RateController {
+public:
+    RateController() { reset(0); }
+    
+    // Start at the riding rate
+    void reset(uint32_t nowMs);
+    
+    // Motion seen since the previous call; returns the rate to stream at
+    int update(const ActivityPeak& peak, uint32_t nowMs);
+    int rate() const { return tierRate(tier_); }
+    
+    static int tierRate(int tier);
+    
+private:
+    static int tierFor(const ActivityPeak& peak);
+    
+    int tier_ = 1;
+    uint32_t heldSince_ = 0;
+    uint32_t lastMotion_ = 0;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer ring of fixed capacity.
+//
+// push() may only be called from one context (e.g. the BLE notification
+// callback) and pop()/popBatch() from one other (e.g. the main loop).
+// Indices are free-running 32-bit counters; Capacity must be a power of
+// two. A push into a full queue drops the item and counts it.
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SPSCQueue() : head_(0), tail_(0), dropped_(0), pushed_(0), highWater_(0) {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer side
+    bool push(const T& item) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        const uint32_t used = head - tail;
+        if (used >= Capacity) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        items_[head & MASK] = item;
+        head_.store(head + 1, std::memory_order_release);
+
+        pushed_.store(pushed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (used + 1 > highWater_.load(std::memory_order_relaxed)) {
+            highWater_.store(used + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        return popBatch(&item, 1) == 1;
+    }
+
+    size_t popBatch(T* out, size_t maxItems) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        size_t n = head - tail;
+        if (n > maxItems) n = maxItems;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = items_[(tail + i) & MASK];
+        }
+        tail_.store(tail + static_cast<uint32_t>(n), std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side: drop everything currently queued
+    void discardAll() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Statistics, written by the producer only
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint32_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+    uint32_t highWater() const { return highWater_.load(std::memory_order_relaxed); }
+
+private:
+    static const uint32_t MASK = Capacity - 1;
+
+    T items_[Capacity];
+    std::atomic<uint32_t> head_;  // next slot to write, owned by the producer
+    std::atomic<uint32_t> tail_;  // next slot to read, owned by the consumer
+    std::atomic<uint32_t> dropped_;
+    std::atomic<uint32_t> pushed_;
+    std::atomic<uint32_t> highWater_;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "SampleBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void SampleBuffer::push(const IMUData& data) {
+    size_t s;
+    if (size_ < capacity_) {
+        s = slot(size_);
+        size_++;
+    } else {
+        // Overwrite the oldest sample
+        s = head_;
+        head_ = (head_ + 1 == capacity_) ? 0 : head_ + 1;
+    }
+
+    columns_.timestamp[s] = data.timestamp;
+    columns_.accX[s] = data.accX;
+    columns_.accY[s] = data.accY;
+    columns_.accZ[s] = data.accZ;
+    columns_.gyroX[s] = data.gyroX;
+    columns_.gyroY[s] = data.gyroY;
+    columns_.gyroZ[s] = data.gyroZ;
+    columns_.velX[s] = data.velX;
+    columns_.velY[s] = data.velY;
+    columns_.velZ[s] = data.velZ;
+    columns_.linAccX[s] = data.linAccX;
+    columns_.linAccY[s] = data.linAccY;
+    columns_.linAccZ[s] = data.linAccZ;
+    columns_.linAcc[s] = data.linAcc;
+    columns_.gyroMag[s] = data.gyroMag;
+}
+
+static void copyColumns(const SampleColumns& dst, size_t to, const SampleColumns& src, size_t from, size_t n) {
+    std::memcpy(dst.timestamp + to, src.timestamp + from, n * sizeof(uint32_t));
+    std::memcpy(dst.accX + to, src.accX + from, n * sizeof(float));
+    std::memcpy(dst.accY + to, src.accY + from, n * sizeof(float));
+    std::memcpy(dst.accZ + to, src.accZ + from, n * sizeof(float));
+    std::memcpy(dst.gyroX + to, src.gyroX + from, n * sizeof(float));
+    std::memcpy(dst.gyroY + to, src.gyroY + from, n * sizeof(float));
+    std::memcpy(dst.gyroZ + to, src.gyroZ + from, n * sizeof(float));
+    std::memcpy(dst.velX + to, src.velX + from, n * sizeof(Scalar));
+    std::memcpy(dst.velY + to, src.velY + from, n * sizeof(Scalar));
+    std::memcpy(dst.velZ + to, src.velZ + from, n * sizeof(Scalar));
+    std::memcpy(dst.linAccX + to, src.linAccX + from, n * sizeof(Scalar));
+    std::memcpy(dst.linAccY + to, src.linAccY + from, n * sizeof(Scalar));
+    std::memcpy(dst.linAccZ + to, src.linAccZ + from, n * sizeof(Scalar));
+    std::memcpy(dst.linAcc + to, src.linAcc + from, n * sizeof(Scalar));
+    std::memcpy(dst.gyroMag + to, src.gyroMag + from, n * sizeof(Scalar));
+}
+
+void SampleBuffer::assign(const SampleBuffer& source, SampleWindow window) {
+    clear();
+    if (window.empty()) return;
+    
+    // Newest samples win when the window is larger than this buffer
+    if (window.size() > capacity_) {
+        window.begin = window.end - capacity_;
+    }
+    
+    // The source range wraps at most once; this buffer starts at slot 0
+    size_t index = window.begin;
+    while (index < window.end) {
+        const size_t from = source.slot(index);
+        const size_t n = std::min(window.end - index, source.capacity_ - from);
+        copyColumns(columns_, size_, source.columns_, from, n);
+        size_ += n;
+        index += n;
+    }
+}
+
+IMUData SampleBuffer::at(size_t index) const {
+    size_t s = slot(index);
+    IMUData data;
+    data.timestamp = columns_.timestamp[s];
+    data.accX = columns_.accX[s];
+    data.accY = columns_.accY[s];
+    data.accZ = columns_.accZ[s];
+    data.gyroX = columns_.gyroX[s];
+    data.gyroY = columns_.gyroY[s];
+    data.gyroZ = columns_.gyroZ[s];
+    data.velX = columns_.velX[s];
+    data.velY = columns_.velY[s];
+    data.velZ = columns_.velZ[s];
+    data.linAccX = columns_.linAccX[s];
+    data.linAccY = columns_.linAccY[s];
+    data.linAccZ = columns_.linAccZ[s];
+    data.linAcc = columns_.linAcc[s];
+    data.gyroMag = columns_.gyroMag[s];
+    return data;
+}
+
+// Timestamps are compared relative to the newest sample so the search
+// stays correct when the 32-bit sensor clock wraps inside the buffer.
+static inline int32_t relativeTime(uint32_t t, uint32_t reference) {
+    return static_cast<int32_t>(t - reference);
+}
+
+size_t SampleBuffer::lowerBound(uint32_t t) const {
+    if (size_ == 0) return 0;
+    const uint32_t newest = timestamp(size_ - 1);
+    const int32_t target = relativeTime(t, newest);
+    size_t lo = 0, hi = size_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (relativeTime(timestamp(mid), newest) < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t SampleBuffer::upperBound(uint32_t t) const {
+    if (size_ == 0) return 0;
+    const uint32_t newest = timestamp(size_ - 1);
+    const int32_t target = relativeTime(t, newest);
+    size_t lo = 0, hi = size_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (relativeTime(timestamp(mid), newest) <= target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+SampleWindow SampleBuffer::window(uint32_t from, uint32_t to) const {
+    SampleWindow w;
+    w.begin = lowerBound(from);
+    w.end = upperBound(to);
+    if (w.end < w.begin) w.end = w.begin;
+    return w;
+}
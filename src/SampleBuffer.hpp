@@ -0,0 +1,116 @@
+#ifndef SAMPLE_BUFFER_H
+#define SAMPLE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Scalar.hpp"
+
+struct IMUData {
+    uint32_t timestamp;                // sensor clock, µs
+    float accX, accY, accZ;
+    float gyroX, gyroY, gyroZ;
+    Scalar velX, velY, velZ;
+
+    // Derived at ingestion with the orientation at that moment
+    Scalar linAccX, linAccY, linAccZ;  // bias and gravity removed, m/s²
+    Scalar linAcc;                     // |linAcc|
+    Scalar gyroMag;                    // |gyro - bias|
+};
+
+// Non-owning range of logical indices [begin, end) into a SampleBuffer
+struct SampleWindow {
+    size_t begin = 0;
+    size_t end = 0;
+
+    size_t size() const { return end - begin; }
+    bool empty() const { return end <= begin; }
+};
+
+// Column pointers of a structure-of-arrays sample store
+struct SampleColumns {
+    uint32_t* timestamp;
+    float* accX;
+    float* accY;
+    float* accZ;
+    float* gyroX;
+    float* gyroY;
+    float* gyroZ;
+    Scalar* velX;
+    Scalar* velY;
+    Scalar* velZ;
+    Scalar* linAccX;
+    Scalar* linAccY;
+    Scalar* linAccZ;
+    Scalar* linAcc;
+    Scalar* gyroMag;
+};
+
+// Fixed-capacity ring of IMU samples stored as structure of arrays.
+//
+// Storage is provided by the owner (see StaticSampleBuffer), so pushing a
+// sample never allocates. Once full, each push overwrites the oldest
+// sample. Logical index 0 is the oldest sample and size() - 1 the newest.
+// slot() maps a logical index to the position in the column arrays; a
+// logical range is contiguous in memory except where it wraps.
+class SampleBuffer {
+public:
+    SampleBuffer(const SampleColumns& columns, size_t capacity)
+        : columns_(columns), capacity_(capacity) {}
+
+    SampleBuffer(const SampleBuffer&) = delete;
+    SampleBuffer& operator=(const SampleBuffer&) = delete;
+
+    void clear() { head_ = 0; size_ = 0; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == capacity_; }
+
+    void push(const IMUData& data);
+    // Replace the contents with a window of another buffer, column by
+    // column with memcpy. Keeps the newest samples if it does not fit.
+    void assign(const SampleBuffer& source, SampleWindow window);
+    IMUData at(size_t index) const;
+    IMUData back() const { return at(size_ - 1); }
+
+    size_t slot(size_t index) const {
+        size_t s = head_ + index;
+        return s >= capacity_ ? s - capacity_ : s;
+    }
+
+    uint32_t timestamp(size_t index) const { return columns_.timestamp[slot(index)]; }
+    Scalar linAcc(size_t index) const { return columns_.linAcc[slot(index)]; }
+    Scalar gyroMag(size_t index) const { return columns_.gyroMag[slot(index)]; }
+    const SampleColumns& columns() const { return columns_; }
+
+    // First logical index whose timestamp is >= t (size() if none)
+    size_t lowerBound(uint32_t t) const;
+    // First logical index whose timestamp is > t (size() if none)
+    size_t upperBound(uint32_t t) const;
+    // Samples with from <= timestamp <= to, found by binary search
+    SampleWindow window(uint32_t from, uint32_t to) const;
+
+protected:
+    SampleColumns columns_;
+    size_t capacity_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+template <size_t N>
+class StaticSampleBuffer : public SampleBuffer {
+public:
+    StaticSampleBuffer()
+        : SampleBuffer(SampleColumns{timestamp_, accX_, accY_, accZ_, gyroX_, gyroY_, gyroZ_, velX_, velY_, velZ_,
+                                     linAccX_, linAccY_, linAccZ_, linAcc_, gyroMag_}, N) {}
+
+private:
+    uint32_t timestamp_[N];
+    float accX_[N], accY_[N], accZ_[N];
+    float gyroX_[N], gyroY_[N], gyroZ_[N];
+    Scalar velX_[N], velY_[N], velZ_[N];
+    Scalar linAccX_[N], linAccY_[N], linAccZ_[N];
+    Scalar linAcc_[N], gyroMag_[N];
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "SampleClock.hpp"
+
+#include "IMUProcessor.hpp"
+
+// The sensor truncates to whole milliseconds; the middle of the
+// millisecond is the unbiased guess for the first row
+static inline uint32_t packetUs(const IMU6Packet& packet) {
+    return packet.timestamp * 1000u + 500u;
+}
+
+void SampleClock::lock(const IMU6Packet& packet) {
+    if (locked_) {
+        relocks_++;
+    }
+    locked_ = true;
+    nextQ8_ = static_cast<uint64_t>(packetUs(packet)) << 8;
+}
+
+void SampleClock::startFit(const IMU6Packet& packet) {
+    fitStartMs_ = packet.timestamp;
+    fitRows_ = 0;
+    suspectQ8_ = 0;
+    coarse_ = false;
+}
+
+void SampleClock::stamp(const IMU6Packet& packet, uint32_t* timestamps) {
+    if (packet.numRows <= 0 || packet.sampleRate <= 0) {
+        return;
+    }
+    
+    const int32_t stepMs = static_cast<int32_t>(packet.timestamp - lastPacketMs_);
+    if (!locked_ || packet.sampleRate != sampleRate_ || stepMs <= 0 || stepMs > SAMPLE_GAP_MS) {
+        // New stream: nominal period from the rate
+        sampleRate_ = packet.sampleRate;
+        periodQ8_ = static_cast<uint32_t>((1000000ull << 8) / static_cast<uint32_t>(packet.sampleRate));
+        lock(packet);
+        startFit(packet);
+    } else {
+        // Period this one packet step alone suggests, coarse to a ms per step
+        const uint32_t stepPeriodQ8 = static_cast<uint32_t>((static_cast<uint64_t>(stepMs) * 1000u << 8) / lastRows_);
+        const bool faster = stepPeriodQ8 < periodQ8_ * 2 / 3;
+        const bool slower = stepPeriodQ8 > periodQ8_ / 2 * 3;
+        const bool slowerAgain = slower && suspectQ8_ > 0 &&
+                                 stepPeriodQ8 > suspectQ8_ / 4 * 3 && stepPeriodQ8 < suspectQ8_ / 4 * 5;
+        if (faster || slowerAgain) {
+            // The rate is not what the packets were decoded with (it
+            // changed, or was only known as 13 Hz per row): start from the
+            // step and measure again from the previous packet
+            periodQ8_ = stepPeriodQ8;
+            fitStartMs_ = lastPacketMs_;
+            fitRows_ = lastRows_;
+            suspectQ8_ = 0;
+            coarse_ = true;
+        } else if (slower) {
+            // Packets went missing, so the rows in between are unknown
+            startFit(packet);
+            suspectQ8_ = stepPeriodQ8;
+        } else {
+            suspectQ8_ = 0;
+            fitRows_ += lastRows_;
+            const uint32_t spanMs = packet.timestamp - fitStartMs_;
+            // A period from a single step is off by up to a ms per step,
+            // so any longer span beats it
+            if (spanMs >= SAMPLE_CLOCK_FIT_MS || coarse_) {
+                periodQ8_ = static_cast<uint32_t>((static_cast<uint64_t>(spanMs) * 1000u << 8) / fitRows_);
+            }
+        }
+        
+        const int32_t errorUs = static_cast<int32_t>(packetUs(packet) - static_cast<uint32_t>(nextQ8_ >> 8));
+        if (errorUs > SAMPLE_CLOCK_RELOCK_US || errorUs < -SAMPLE_CLOCK_RELOCK_US) {
+            lock(packet);
+        } else {
+            nextQ8_ += static_cast<int64_t>(errorUs) * 256 / (1 << SAMPLE_CLOCK_SLEW_SHIFT);
+        }
+    }
+    
+    for (int i = 0; i < packet.numRows; ++i) {
+        timestamps[i] = static_cast<uint32_t>(nextQ8_ >> 8);
+        nextQ8_ += periodQ8_;
+    }
+    lastPacketMs_ = packet.timestamp;
+    lastRows_ = packet.numRows;
+}
@@ -0,0 +1,66 @@
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#include <cstdint>
+#include "MovesenseIMU6.hpp"
+
+// The sample period is measured from the packet timestamps once they span
+// this long; until then the nominal 1/rate is used
+#define SAMPLE_CLOCK_FIT_MS 500
+// A packet this far (µs) from where the row schedule expects it restarts
+// the schedule at the packet
+#define SAMPLE_CLOCK_RELOCK_US 3000
+// Each packet pulls the schedule 1/2^SHIFT of the way to its timestamp
+#define SAMPLE_CLOCK_SLEW_SHIFT 4
+
+// Microsecond timestamps for the rows of one sensor's IMU6 packets.
+//
+// A packet only carries the sensor's millisecond time of its first row;
+// at 833 Hz that is less than one tick per sample. Rows are therefore
+// spaced by the sample period instead: 1/rate of the rate the packet was
+// decoded with at first, then the period measured from the packet
+// timestamps since the stream started. The measured period also takes in
+// the sensor crystal's error. The schedule runs on from packet to packet,
+// so consecutive rows are one period apart, and each packet pulls it a
+// little towards its own timestamp (taken as the middle of its
+// millisecond) to keep it in phase.
+//
+// A new rate or a gap in the packets over SAMPLE_GAP_MS starts over from
+// the nominal period. Lost packets restart the measurement but keep the
+// period. Packet steps that keep disagreeing with the period by half or
+// more (a rate change the decoder was not told about) restart it from the
+// step, refined by every packet after it.
+//
+// Times are on the sensor clock in µs modulo 2^32, like micros(): they
+// wrap after about 71 minutes, so they are only ever compared by their
+// difference.
+class SampleClock {
+public:
+    void reset() { locked_ = false; relocks_ = 0; }
+    
+    // Timestamps of the packet's rows, packet.numRows of them
+    void stamp(const IMU6Packet& packet, uint32_t* timestamps);
+    
+    // Times the schedule had to restart at a packet since reset()
+    uint32_t relocks() const { return relocks_; }
+    // Sample period in use, µs
+    float periodUs() const { return periodQ8_ / 256.0f; }
+    
+private:
+    void lock(const IMU6Packet& packet);
+    void startFit(const IMU6Packet& packet);
+    
+    bool locked_ = false;
+    int sampleRate_ = 0;
+    uint64_t nextQ8_ = 0;       // time of the next row, µs << 8
+    uint32_t periodQ8_ = 0;     // µs << 8
+    uint32_t lastPacketMs_ = 0;
+    int lastRows_ = 0;
+    uint32_t fitStartMs_ = 0;
+    uint32_t fitRows_ = 0;      // rows from fitStartMs_ up to the current packet
+    uint32_t suspectQ8_ = 0;    // period of the last step that was too slow
+    bool coarse_ = false;       // periodQ8_ comes from a single packet step
+    uint32_t relocks_ = 0;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "SampleQueue.hpp"
+
+#include <cstring>
+
+int enqueueIMU6Packet(const IMU6Packet& packet, SampleQueue& queue,
+                      const uint32_t* timestamps, int firstRow) {
+    // decodeIMU6Packet already validated the payload length
+    const uint8_t* accBytes = packet.accBlock();
+    const uint8_t* gyroBytes = packet.gyroBlock();
+
+    int queued = 0;
+    for (int i = firstRow; i < packet.numRows; ++i) {
+        RawSample sample;
+        sample.timestamp = timestamps ? timestamps[i] : packet.rowTimestampUs(i);
+        memcpy(sample.acc, accBytes + i * IMU6_SENSOR_DATA_SIZE, sizeof(sample.acc));
+        memcpy(sample.gyro, gyroBytes + i * IMU6_SENSOR_DATA_SIZE, sizeof(sample.gyro));
+        if (queue.push(sample)) {
+            queued++;
+        }
+    }
+    return queued;
+}
+
+size_t drainSampleQueue(SampleQueue& queue, IMUProcessor& processor, size_t maxSamples) {
+    RawSample batch[SAMPLE_DRAIN_BATCH];
+    float acc[SAMPLE_DRAIN_BATCH * 3];
+    float gyro[SAMPLE_DRAIN_BATCH * 3];
+    uint32_t timestamps[SAMPLE_DRAIN_BATCH];
+
+    size_t processed = 0;
+    while (processed < maxSamples) {
+        size_t want = maxSamples - processed;
+        if (want > SAMPLE_DRAIN_BATCH) want = SAMPLE_DRAIN_BATCH;
+
+        size_t n = queue.popBatch(batch, want);
+        if (n == 0) break;
+
+        for (size_t i = 0; i < n; ++i) {
+            timestamps[i] = batch[i].timestamp;
+            for (int k = 0; k < 3; ++k) {
+                acc[3 * i + k] = batch[i].acc[k];
+                gyro[3 * i + k] = batch[i].gyro[k];
+            }
+        }
+        processor.processBatch(acc, gyro, timestamps, n);
+        processed += n;
+    }
+    return processed;
+}
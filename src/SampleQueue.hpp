@@ -0,0 +1,33 @@
+#ifndef SAMPLE_QUEUE_H
+#define SAMPLE_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "IMUProcessor.hpp"
+#include "MovesenseIMU6.hpp"
+#include "SPSCQueue.hpp"
+
+#define SAMPLE_QUEUE_SIZE 128
+#define SAMPLE_DRAIN_BATCH 16
+
+// One decoded IMU6 row as handed from the BLE callback to the processor
+struct RawSample {
+    uint32_t timestamp;     // µs
+    float acc[3];
+    float gyro[3];
+};
+
+typedef SPSCQueue<RawSample, SAMPLE_QUEUE_SIZE> SampleQueue;
+
+// Producer: decode the rows of a packet from firstRow on into the queue,
+// stamped with timestamps (one per row, µs; the nominal row times when
+// nullptr). Returns the number of rows queued; rows that did not fit are
+// counted as dropped.
+int enqueueIMU6Packet(const IMU6Packet& packet, SampleQueue& queue,
+                      const uint32_t* timestamps = nullptr, int firstRow = 0);
+
+// Consumer: feed up to maxSamples queued samples to the processor in
+// batches of SAMPLE_DRAIN_BATCH. Returns the number of samples processed.
+size_t drainSampleQueue(SampleQueue& queue, IMUProcessor& processor, size_t maxSamples = SAMPLE_QUEUE_SIZE);
+
+#endif
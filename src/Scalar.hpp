@@ -0,0 +1,19 @@
+#ifndef SCALAR_H
+#define SCALAR_H
+
+// Floating-point type of the fusion and metric code.
+//
+// The nRF52840's Cortex-M4F only has a single-precision FPU, so the
+// firmware computes in float; every double operation would be a software
+// routine. Host builds can define AXONA_DOUBLE_PRECISION to get a double
+// reference build of the same code for accuracy comparisons.
+#ifdef AXONA_DOUBLE_PRECISION
+typedef double Scalar;
+#else
+typedef float Scalar;
+#endif
+
+// Literal in the configured precision, e.g. S(0.5)
+#define S(x) static_cast<Scalar>(x)
+
+#endif
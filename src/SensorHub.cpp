@@ -0,0 +1,115 @@
+#include "SensorHub.hpp"
+
+void ClockAlignment::reset() {
+    offsetUs_.store(0, std::memory_order_relaxed);
+    valid_ = false;
+}
+
+void ClockAlignment::update(uint32_t sampleUs, uint32_t arrivalUs) {
+    const uint32_t bound = arrivalUs - sampleUs;
+    
+    if (!valid_) {
+        offsetUs_.store(bound, std::memory_order_relaxed);
+        windowStartUs_ = arrivalUs;
+        windowMinUs_ = bound;
+        valid_ = true;
+        return;
+    }
+    
+    if (static_cast<int32_t>(bound - windowMinUs_) < 0) {
+        windowMinUs_ = bound;
+        // A tighter bound than the one in use is always better
+        if (static_cast<int32_t>(bound - offsetUs_.load(std::memory_order_relaxed)) < 0) {
+            offsetUs_.store(bound, std::memory_order_relaxed);
+        }
+    }
+    
+    if (arrivalUs - windowStartUs_ >= CLOCK_ALIGN_WINDOW_MS * 1000u) {
+        // Adopt this window's minimum, which may be later than the current
+        // estimate if the sensor clock runs slow
+        offsetUs_.store(windowMinUs_, std::memory_order_relaxed);
+        windowStartUs_ = arrivalUs;
+        windowMinUs_ = bound;
+    }
+}
+
+void SensorPipeline::reset() {
+    queue.discardAll();
+    processor.restart();
+    clock.reset();
+    sampleClock.reset();
+    lastTimestamp = 0;
+    streaming = false;
+    arrivals.reset();
+}
+
+SensorHub::SensorHub() {
+    for (size_t i = 0; i < SENSOR_MAX_DEVICES; ++i) {
+        pipelines_[i].id = static_cast<uint8_t>(i);
+    }
+}
+
+SensorPipeline* SensorHub::attach() {
+    for (size_t i = 0; i < SENSOR_MAX_DEVICES; ++i) {
+        if (!pipelines_[i].attached) {
+            // A new sensor: nothing of the previous one's calibration applies
+            pipelines_[i].reset();
+            pipelines_[i].processor.clearData();
+            pipelines_[i].attached = true;
+            return &pipelines_[i];
+        }
+    }
+    return nullptr;
+}
+
+void SensorHub::detach(SensorPipeline* pipeline) {
+    if (pipeline) {
+        pipeline->attached = false;
+        pipeline->queue.discardAll();
+    }
+}
+
+size_t SensorHub::attached() const {
+    size_t n = 0;
+    for (size_t i = 0; i < SENSOR_MAX_DEVICES; ++i) {
+        if (pipelines_[i].attached) n++;
+    }
+    return n;
+}
+
+int SensorHub::ingest(SensorPipeline& pipeline, const IMU6Packet& packet, uint32_t arrivalUs) {
+    if (packet.numRows <= 0 || packet.numRows > IMU6_MAX_ROWS) {
+        return 0;
+    }
+    uint32_t timestamps[IMU6_MAX_ROWS];
+    pipeline.sampleClock.stamp(packet, timestamps);
+    const uint32_t newest = timestamps[packet.numRows - 1];
+    pipeline.clock.update(newest, arrivalUs);
+    
+    // An older timestamp further back than a gap is a restarted sensor
+    // clock, which IMUProcessor handles as a gap; those rows are kept
+    int firstRow = 0;
+    if (pipeline.streaming) {
+        while (firstRow < packet.numRows) {
+            const int32_t step = static_cast<int32_t>(timestamps[firstRow] - pipeline.lastTimestamp);
+            if (step > 0 || step <= -SAMPLE_GAP_MS * 1000) break;
+            firstRow++;
+        }
+    }
+    if (firstRow < packet.numRows) {
+        pipeline.lastTimestamp = newest;
+        pipeline.streaming = true;
+        pipeline.arrivals.add(timestamps[firstRow], newest, arrivalUs);
+    }
+    return enqueueIMU6Packet(packet, pipeline.queue, timestamps, firstRow);
+}
+
+size_t SensorHub::drain(size_t maxSamplesPerSensor) {
+    size_t processed = 0;
+    for (size_t i = 0; i < SENSOR_MAX_DEVICES; ++i) {
+        if (pipelines_[i].attached) {
+            processed += drainSampleQueue(pipelines_[i].queue, pipelines_[i].processor, maxSamplesPerSensor);
+        }
+    }
+    return processed;
+}
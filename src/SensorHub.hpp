@@ -0,0 +1,108 @@
+#ifndef SENSOR_HUB_H
+#define SENSOR_HUB_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "IMUProcessor.hpp"
+#include "LatencyTrace.hpp"
+#include "MovesenseIMU6.hpp"
+#include "SampleClock.hpp"
+#include "SampleQueue.hpp"
+
+// Sensors that can stream at the same time, e.g. helmet and bike frame
+#define SENSOR_MAX_DEVICES 2
+// RAM budget of one sensor pipeline (queue, processor, buffers); the hub
+// takes SENSOR_MAX_DEVICES times this, statically allocated
+#define SENSOR_PIPELINE_BUDGET (72 * 1024)
+// Sensor-to-receiver clock offset is re-estimated over windows this long,
+// which follows crystal drift between the sensors and the receiver
+#define CLOCK_ALIGN_WINDOW_MS 10000
+
+// Maps a sensor's sample times (µs, see SampleClock) onto the receiver's
+// micros().
+//
+// Every packet arrives some unknown but non-negative latency after its
+// newest sample was taken, so arrival - sampleTime is an upper bound of
+// the clock offset. The smallest bound seen in a window is the estimate;
+// it is held for the next window so aligned times do not jitter. All
+// arithmetic is modulo 2^32, like micros() itself.
+class ClockAlignment {
+public:
+    ClockAlignment() : offsetUs_(0) {}
+    
+    void reset();
+    // Producer side: newest sample time of a packet and its arrival time
+    void update(uint32_t sampleUs, uint32_t arrivalUs);
+    
+    bool valid() const { return valid_; }
+    int32_t offsetUs() const { return static_cast<int32_t>(offsetUs_.load(std::memory_order_relaxed)); }
+    // Receiver micros() at which a sample with this timestamp was taken
+    uint32_t toReceiverUs(uint32_t sampleUs) const {
+        return sampleUs + offsetUs_.load(std::memory_order_relaxed);
+    }
+    
+private:
+    std::atomic<uint32_t> offsetUs_;
+    bool valid_ = false;
+    uint32_t windowStartUs_ = 0;
+    uint32_t windowMinUs_ = 0;
+};
+
+// Everything one sensor needs: its sample queue, processor and clocks
+struct SensorPipeline {
+    uint8_t id = 0;
+    bool attached = false;
+    SampleQueue queue;
+    IMUProcessor processor;
+    ClockAlignment clock;
+    // Producer side: row timestamps, and the newest one queued so far
+    SampleClock sampleClock;
+    uint32_t lastTimestamp = 0;
+    bool streaming = false;
+    // Arrival times of the latest packets, for latency tracing
+    PacketArrivals arrivals;
+    
+    // Restart the stream from scratch; the processor keeps its calibration
+    void reset();
+};
+
+// Fixed set of per-sensor pipelines.
+//
+// The BLE callback hands every packet to ingest() on the pipeline of the
+// device that sent it; loop() drains all of them. Impact trigger times
+// stay in each sensor's own clock inside the pipeline; ClockAlignment puts
+// them on the receiver's clock so impacts seen by different sensors can
+// be correlated.
+class SensorHub {
+public:
+    SensorHub();
+    SensorHub(const SensorHub&) = delete;
+    SensorHub& operator=(const SensorHub&) = delete;
+    
+    // Claims a free pipeline, reset; nullptr if all are in use
+    SensorPipeline* attach();
+    void detach(SensorPipeline* pipeline);
+    
+    SensorPipeline& pipeline(size_t id) { return pipelines_[id]; }
+    static constexpr size_t capacity() { return SENSOR_MAX_DEVICES; }
+    size_t attached() const;
+    
+    // Producer: stamp a decoded packet's rows, queue them and update the
+    // clock estimate.
+    // Rows that overlap samples already queued (the two subscriptions
+    // around a rate change) are skipped. Returns the number of rows queued.
+    int ingest(SensorPipeline& pipeline, const IMU6Packet& packet, uint32_t arrivalUs);
+    // Consumer: drain every attached pipeline into its processor
+    size_t drain(size_t maxSamplesPerSensor = SAMPLE_QUEUE_SIZE);
+    
+private:
+    SensorPipeline pipelines_[SENSOR_MAX_DEVICES];
+};
+
+// The double-precision reference build only runs on the host
+#ifndef AXONA_DOUBLE_PRECISION
+static_assert(sizeof(SensorPipeline) <= SENSOR_PIPELINE_BUDGET, "sensor pipeline exceeds its RAM budget");
+#endif
+
+#endif
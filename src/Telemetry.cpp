@@ -0,0 +1,108 @@
+#include "Telemetry.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Crc32.hpp"
+
+namespace {
+
+void put32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+
+void putFloat(uint8_t* p, Scalar value) {
+    float f = static_cast<float>(value);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    put32(p, bits);
+}
+
+} // namespace
+
+TelemetryWriter::TelemetryWriter() {
+    // Leading delimiter: separates the first frame from any earlier text
+    ring_[0] = 0;
+    head_ = 1;
+}
+
+bool TelemetryWriter::writeSamples(const IMU6Packet& packet, uint32_t arrivalUs, uint8_t device) {
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    if (packet.length > IMU6_MAX_LENGTH) return false;
+    
+    payload[0] = device;
+    put32(payload + 1, arrivalUs);
+    std::memcpy(payload + TELEMETRY_SAMPLES_HEADER_SIZE, packet.data, packet.length);
+    return writeFrame(TELEMETRY_SAMPLES, payload, TELEMETRY_SAMPLES_HEADER_SIZE + packet.length);
+}
+
+bool TelemetryWriter::writeImpact(const ImpactReport& report, uint32_t receiverUs, uint8_t device) {
+    uint8_t payload[TELEMETRY_IMPACT_SIZE];
+    payload[0] = device;
+    put32(payload + 1, report.triggerTime);
+    put32(payload + 5, receiverUs);
+    payload[9] = static_cast<uint8_t>(report.level);
+    putFloat(payload + 10, report.hic.hic15);
+    putFloat(payload + 14, report.hic.hic36);
+    putFloat(payload + 18, report.peakAcc);
+    putFloat(payload + 22, report.ridingVelocity);
+    putFloat(payload + 26, report.headVelocity);
+    return writeFrame(TELEMETRY_IMPACT, payload, sizeof(payload));
+}
+
+bool TelemetryWriter::writeStats(const TelemetryStats& stats) {
+    uint8_t payload[TELEMETRY_STATS_SIZE];
+    put32(payload, stats.uptimeMs);
+    put32(payload + 4, stats.samplesPushed);
+    put32(payload + 8, stats.samplesDropped);
+    put32(payload + 12, stats.queueHighWater);
+    put32(payload + 16, stats.framesDropped);
+    put32(payload + 20, stats.eventLogRecords);
+    return writeFrame(TELEMETRY_STATS, payload, sizeof(payload));
+}
+
+bool TelemetryWriter::writeFrame(uint8_t type, const uint8_t* payload, size_t length) {
+    uint8_t raw[2 + TELEMETRY_MAX_PAYLOAD + 4];
+    uint8_t encoded[TELEMETRY_MAX_FRAME];
+    
+    raw[0] = type;
+    // Dropped frames use up their sequence number too, so the host sees the gap
+    raw[1] = sequence_++;
+    std::memcpy(raw + 2, payload, length);
+    put32(raw + 2 + length, crc32(raw, 2 + length));
+    
+    size_t size = cobsEncode(raw, 2 + length + 4, encoded);
+    encoded[size++] = 0;
+    
+    // Whole frames only, and samples stay out of the reserve
+    const size_t limit = type == TELEMETRY_SAMPLES ? TELEMETRY_TX_BUFFER_SIZE - TELEMETRY_RECORD_RESERVE
+                                                   : TELEMETRY_TX_BUFFER_SIZE;
+    if (pending() + size > limit) {
+        framesDropped_++;
+        if (type != TELEMETRY_SAMPLES) recordsDropped_++;
+        return false;
+    }
+    
+    const uint32_t start = head_ & (TELEMETRY_TX_BUFFER_SIZE - 1);
+    const size_t first = std::min(size, static_cast<size_t>(TELEMETRY_TX_BUFFER_SIZE - start));
+    std::memcpy(ring_ + start, encoded, first);
+    std::memcpy(ring_, encoded + first, size - first);
+    head_ += size;
+    
+    framesWritten_++;
+    return true;
+}
+
+size_t TelemetryWriter::pump(size_t maxBytes, Sink sink, void* context) {
+    size_t written = 0;
+    while (written < maxBytes && pending() > 0) {
+        // Contiguous run up to the end of the ring
+        const uint32_t start = tail_ & (TELEMETRY_TX_BUFFER_SIZE - 1);
+        size_t run = std::min(pending(), static_cast<size_t>(TELEMETRY_TX_BUFFER_SIZE - start));
+        run = std::min(run, maxBytes - written);
+        
+        const size_t taken = sink(ring_ + start, run, context);
+        tail_ += taken;
+        written += taken;
+        if (taken < run) break;
+    }
+    return written;
+}
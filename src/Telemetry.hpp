@@ -0,0 +1,94 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Cobs.hpp"
+#include "MetricJob.hpp"
+#include "MovesenseIMU6.hpp"
+
+// Binary serial telemetry.
+//
+// Every frame is [type:u8][sequence:u8][payload][crc32:u32 over type..payload],
+// COBS-encoded and terminated by 0x00. The sequence counts every frame,
+// written or dropped, so a receiver can see gaps. Multi-byte values are
+// little endian, floats are IEEE 754 single precision. The stream starts
+// with a 0x00 so text printed before it cannot run into the first frame.
+#define TELEMETRY_TX_BUFFER_SIZE 2048
+// Ring space sample frames may not use, kept for impact and stats frames
+// (about 40 bytes each): at 416 Hz and above the sample stream alone
+// fills the UART, and the ring with it
+#define TELEMETRY_RECORD_RESERVE 256
+
+enum TelemetryRecord : uint8_t {
+    // [device:u8][arrivalUs:u32][IMU6 notification]: one Movesense IMU6
+    // payload exactly as the notification callback received it, stamped
+    // with micros()
+    TELEMETRY_SAMPLES = 1,
+    // [device:u8][triggerTime:u32][receiverUs:u32][level:u8][hic15][hic36]
+    // [peakAcc][ridingVelocity][headVelocity]; triggerTime is the sensor's
+    // clock in µs, receiverUs the same instant on the receiver's micros()
+    TELEMETRY_IMPACT = 2,
+    // [uptimeMs:u32][samplesPushed:u32][samplesDropped:u32][queueHighWater:u32]
+    // [framesDropped:u32][eventLogRecords:u32]
+    TELEMETRY_STATS = 3
+};
+
+#define TELEMETRY_SAMPLES_HEADER_SIZE 5
+#define TELEMETRY_IMPACT_SIZE 30
+#define TELEMETRY_STATS_SIZE 24
+#define TELEMETRY_MAX_PAYLOAD (TELEMETRY_SAMPLES_HEADER_SIZE + IMU6_MAX_LENGTH)
+#define TELEMETRY_MAX_FRAME (COBS_MAX_ENCODED_SIZE(2 + TELEMETRY_MAX_PAYLOAD + 4) + 1)
+
+struct TelemetryStats {
+    uint32_t uptimeMs = 0;
+    uint32_t samplesPushed = 0;
+    uint32_t samplesDropped = 0;
+    uint32_t queueHighWater = 0;
+    uint32_t framesDropped = 0;
+    uint32_t eventLogRecords = 0;
+};
+
+// Frames records into a fixed TX ring without ever blocking.
+//
+// write*() encode a whole frame into the ring, or drop it (and count the
+// drop) if the ring cannot take all of it; a frame is never split. Sample
+// frames also leave the last TELEMETRY_RECORD_RESERVE bytes free, so when
+// the link falls behind they are the ones dropped, not impacts. pump()
+// hands queued bytes to a sink that accepts at most maxBytes, e.g. what
+// Serial.availableForWrite() reports, so the caller never waits on the UART.
+class TelemetryWriter {
+public:
+    // Writes up to length bytes, returns how many it took
+    typedef size_t (*Sink)(const uint8_t* data, size_t length, void* context);
+    
+    TelemetryWriter();
+    
+    bool writeSamples(const IMU6Packet& packet, uint32_t arrivalUs, uint8_t device = 0);
+    bool writeImpact(const ImpactReport& report, uint32_t receiverUs, uint8_t device = 0);
+    bool writeStats(const TelemetryStats& stats);
+    
+    // Move up to maxBytes to the sink; returns the bytes written
+    size_t pump(size_t maxBytes, Sink sink, void* context);
+    
+    size_t pending() const { return head_ - tail_; }
+    uint32_t framesWritten() const { return framesWritten_; }
+    uint32_t framesDropped() const { return framesDropped_; }
+    // Impact and stats frames among the dropped ones
+    uint32_t recordsDropped() const { return recordsDropped_; }
+    
+private:
+    bool writeFrame(uint8_t type, const uint8_t* payload, size_t length);
+    
+    static_assert((TELEMETRY_TX_BUFFER_SIZE & (TELEMETRY_TX_BUFFER_SIZE - 1)) == 0, "TX buffer size must be a power of two");
+    
+    uint8_t ring_[TELEMETRY_TX_BUFFER_SIZE];
+    uint32_t head_ = 0;
+    uint32_t tail_ = 0;
+    uint8_t sequence_ = 0;
+    uint32_t framesWritten_ = 0;
+    uint32_t framesDropped_ = 0;
+    uint32_t recordsDropped_ = 0;
+};
+
+#endif
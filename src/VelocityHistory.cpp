@@ -0,0 +1,41 @@
+#include "VelocityHistory.hpp"
+
+void VelocityHistory::add(uint32_t timestamp, Scalar speed) {
+    if (size_ > 0) {
+        size_t newest = head_ + size_ - 1;
+        if (newest >= VELOCITY_HISTORY_BINS) newest -= VELOCITY_HISTORY_BINS;
+        if (timestamp - start_[newest] < VELOCITY_HISTORY_BIN_MS * 1000u && count_[newest] < UINT16_MAX) {
+            sum_[newest] += speed;
+            count_[newest]++;
+            return;
+        }
+    }
+
+    // New bin, overwriting the oldest once full
+    size_t slot;
+    if (size_ < VELOCITY_HISTORY_BINS) {
+        slot = head_ + size_;
+        if (slot >= VELOCITY_HISTORY_BINS) slot -= VELOCITY_HISTORY_BINS;
+        size_++;
+    } else {
+        slot = head_;
+        head_ = head_ + 1 == VELOCITY_HISTORY_BINS ? 0 : head_ + 1;
+    }
+    start_[slot] = timestamp;
+    sum_[slot] = speed;
+    count_[slot] = 1;
+}
+
+Scalar VelocityHistory::average(uint32_t from, uint32_t to) const {
+    Scalar total = 0;
+    size_t bins = 0;
+    for (size_t i = 0; i < size_; ++i) {
+        size_t s = head_ + i;
+        if (s >= VELOCITY_HISTORY_BINS) s -= VELOCITY_HISTORY_BINS;
+        if (start_[s] - from <= to - from) {
+            total += sum_[s] / count_[s];
+            bins++;
+        }
+    }
+    return bins > 0 ? total / bins : 0;
+}
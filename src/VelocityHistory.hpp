@@ -0,0 +1,43 @@
+#ifndef VELOCITY_HISTORY_H
+#define VELOCITY_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Scalar.hpp"
+
+// Span of one bin of the speed history
+#define VELOCITY_HISTORY_BIN_MS 50
+// 10 s of bins: the riding-velocity window ends 5 s before an impact and
+// is 4 s long, plus a margin
+#define VELOCITY_HISTORY_BINS 200
+
+// Speed (|velocity|, m/s) over the last VELOCITY_HISTORY_BINS bins of
+// VELOCITY_HISTORY_BIN_MS each, whatever the sample rate.
+//
+// The sample buffers hold a fixed number of samples, which at the higher
+// IMU6 rates is well under the 9 s the riding velocity looks back; this
+// keeps that span at a few KiB. A bin starts at the first sample that
+// falls outside the previous one and holds the sum and count of its
+// samples. Times are µs on the sensor clock and compared by difference,
+// so the history carries over the 32-bit wrap.
+class VelocityHistory {
+public:
+    void clear() { head_ = 0; size_ = 0; }
+    void add(uint32_t timestamp, Scalar speed);
+
+    // Time average of the bins that start within [from, to]: the mean of
+    // the bin means, so a stretch sampled at a higher rate does not weigh
+    // more. 0 if there are none.
+    Scalar average(uint32_t from, uint32_t to) const;
+
+    size_t size() const { return size_; }
+
+private:
+    uint32_t start_[VELOCITY_HISTORY_BINS];
+    Scalar sum_[VELOCITY_HISTORY_BINS];
+    uint16_t count_[VELOCITY_HISTORY_BINS];
+    size_t head_ = 0;   // oldest bin
+    size_t size_ = 0;
+};
+
+#endif